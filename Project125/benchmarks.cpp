@@ -0,0 +1,531 @@
+#include "benchmarks.h"
+
+#include <execution>
+#include <random>
+#include <filesystem>
+#include <string>
+#include <memory>
+#include <iterator>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <unordered_map>
+#include <set>
+#include <algorithm>
+#include <fstream>
+
+#include "corpus_ingestion.h"
+#include "log_duration.h"
+#include "process_queries.h"
+#include "remove_duplicates.h"
+#include "search_server.h"
+#include "sharded_search_server.h"
+#include "string_processing.h"
+#include "term_dictionary.h"
+
+static std::string generateWord(std::mt19937& generator, int max_length) {
+    const int length = std::uniform_int_distribution(1, max_length)(generator);
+    std::string word;
+    word.reserve(length);
+    for (int i = 0; i < length; ++i) {
+        word.push_back(std::uniform_int_distribution('a', 'z')(generator));
+    }
+    return word;
+}
+
+static std::vector<std::string> generateDictionary(std::mt19937& generator, int word_count, int max_length) {
+    std::vector<std::string> words;
+    words.reserve(word_count);
+    for (int i = 0; i < word_count; ++i) {
+        words.push_back(generateWord(generator, max_length));
+    }
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    return words;
+}
+
+static std::string generateQuery(std::mt19937& generator, const std::vector<std::string>& dictionary, int word_count, double minus_prob = 0) {
+    std::string query;
+    for (int i = 0; i < word_count; ++i) {
+        if (!query.empty()) {
+            query.push_back(' ');
+        }
+        if (std::uniform_real_distribution<>(0, 1)(generator) < minus_prob) {
+            query.push_back('-');
+        }
+        query += dictionary[std::uniform_int_distribution<int>(0, static_cast<int>(dictionary.size()) - 1)(generator)];
+    }
+    return query;
+}
+
+void BenchmarkFindTopDocuments(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 1000, 10);
+    for (const int document_count : { 1000, 5000, 20000 }) {
+        SearchServer search_server(dictionary[0]);
+        for (int i = 0; i < document_count; ++i) {
+            search_server.AddDocument(i, generateQuery(generator, dictionary, 70), DocumentStatus::ACTUAL, { 1, 2, 3 });
+        }
+        std::vector<std::string> queries;
+        for (int i = 0; i < 100; ++i) {
+            queries.push_back(generateQuery(generator, dictionary, 10, 0.1));
+        }
+
+        out << "Documents: "s << document_count << ", average posting size: "s << document_count * 70 / static_cast<int>(dictionary.size()) << std::endl;
+        double seq_total = 0;
+        double par_total = 0;
+        {
+            LOG_DURATION_STREAM("  seq"s, out);
+            for (const std::string& query : queries) {
+                for (const Document& document : search_server.FindTopDocuments(std::execution::seq, query)) {
+                    seq_total += document.relevance;
+                }
+            }
+        }
+        {
+            LOG_DURATION_STREAM("  par"s, out);
+            for (const std::string& query : queries) {
+                for (const Document& document : search_server.FindTopDocuments(std::execution::par, query)) {
+                    par_total += document.relevance;
+                }
+            }
+        }
+        if (seq_total != par_total) {
+            out << "  seq and par results differ"s << std::endl;
+        }
+    }
+}
+
+void BenchmarkProcessQueries(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 2000, 25);
+    SearchServer search_server(dictionary[0]);
+    for (int i = 0; i < 10000; ++i) {
+        search_server.AddDocument(i, generateQuery(generator, dictionary, 100), DocumentStatus::ACTUAL, { 1, 2, 3 });
+    }
+    std::vector<std::string> queries;
+    for (int i = 0; i < 500; ++i) {
+        queries.push_back(generateQuery(generator, dictionary, 10));
+    }
+
+    out << "Queries: "s << queries.size() << std::endl;
+    std::size_t loop_count = 0;
+    {
+        LOG_DURATION_STREAM("  loop"s, out);
+        for (const std::string& query : queries) {
+            loop_count += search_server.FindTopDocuments(query).size();
+        }
+    }
+    std::size_t batch_count = 0;
+    {
+        LOG_DURATION_STREAM("  ProcessQueries"s, out);
+        batch_count = ProcessQueriesJoined(search_server, queries).size();
+    }
+    if (loop_count != batch_count) {
+        out << "  loop and batch results differ"s << std::endl;
+    }
+}
+
+void BenchmarkShardedSearchServer(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 1000, 10);
+    SearchServer search_server(dictionary[0]);
+    ShardedSearchServer sharded_server(dictionary[0]);
+    for (int i = 0; i < 20000; ++i) {
+        const std::string document = generateQuery(generator, dictionary, 70);
+        search_server.AddDocument(i, document, DocumentStatus::ACTUAL, { 1, 2, 3 });
+        sharded_server.AddDocument(i, document, DocumentStatus::ACTUAL, { 1, 2, 3 });
+    }
+    std::vector<std::string> queries;
+    for (int i = 0; i < 100; ++i) {
+        queries.push_back(generateQuery(generator, dictionary, 10, 0.1));
+    }
+
+    out << "Shards: "s << sharded_server.GetShardCount() << std::endl;
+    double single_total = 0;
+    double sharded_total = 0;
+    {
+        LOG_DURATION_STREAM("  single"s, out);
+        for (const std::string& query : queries) {
+            for (const Document& document : search_server.FindTopDocuments(query)) {
+                single_total += document.relevance;
+            }
+        }
+    }
+    {
+        LOG_DURATION_STREAM("  sharded"s, out);
+        for (const std::string& query : queries) {
+            for (const Document& document : sharded_server.FindTopDocuments(query)) {
+                sharded_total += document.relevance;
+            }
+        }
+    }
+    if (std::abs(single_total - sharded_total) > EPSILON) {
+        out << "  single and sharded results differ"s << std::endl;
+    }
+}
+
+void BenchmarkIndexFile(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 1000, 10);
+    std::vector<std::string> documents;
+    for (int i = 0; i < 20000; ++i) {
+        documents.push_back(generateQuery(generator, dictionary, 70));
+    }
+    const std::string path = (std::filesystem::temp_directory_path() / "search_server_benchmark.index"s).string();
+
+    out << "Documents: "s << documents.size() << std::endl;
+    SearchServer search_server(dictionary[0]);
+    {
+        LOG_DURATION_STREAM("  AddDocument"s, out);
+        for (int i = 0; i < static_cast<int>(documents.size()); ++i) {
+            search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, { 1, 2, 3 });
+        }
+    }
+    {
+        LOG_DURATION_STREAM("  Save"s, out);
+        search_server.Save(path);
+    }
+    SearchServer loaded_server;
+    {
+        LOG_DURATION_STREAM("  Load"s, out);
+        loaded_server.Load(path);
+    }
+    {
+        LOG_DURATION_STREAM("  Load with checksums"s, out);
+        loaded_server.Load(path, true);
+    }
+    const std::string query = generateQuery(generator, dictionary, 10, 0.1);
+    if (loaded_server.FindTopDocuments(query).size() != search_server.FindTopDocuments(query).size()) {
+        out << "  loaded and built results differ"s << std::endl;
+    }
+    std::filesystem::remove(path);
+}
+
+void BenchmarkWriteAheadLog(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 1000, 10);
+    std::vector<std::string> documents;
+    for (int i = 0; i < 2000; ++i) {
+        documents.push_back(generateQuery(generator, dictionary, 70));
+    }
+    const std::string snapshot_path = (std::filesystem::temp_directory_path() / "search_server_benchmark.snapshot"s).string();
+    const std::string log_path = (std::filesystem::temp_directory_path() / "search_server_benchmark.log"s).string();
+
+    WriteAheadLogOptions every_record;
+    every_record.sync_batch_records = 1;
+    WriteAheadLogOptions batched;
+
+    const auto add_documents = [&](const std::string& name, const WriteAheadLogOptions* options) {
+        std::filesystem::remove(snapshot_path);
+        std::filesystem::remove(log_path);
+        SearchServer search_server(dictionary[0]);
+        if (options != nullptr) {
+            search_server.Recover(snapshot_path, log_path, *options);
+        }
+        LOG_DURATION_STREAM(name, out);
+        for (int i = 0; i < static_cast<int>(documents.size()); ++i) {
+            search_server.AddDocument(i, documents[i], DocumentStatus::ACTUAL, { 1, 2, 3 });
+        }
+        search_server.SyncWriteAheadLog();
+    };
+
+    out << "Documents: "s << documents.size() << std::endl;
+    add_documents("  no log"s, nullptr);
+    add_documents("  fsync per document"s, &every_record);
+    add_documents("  group commit"s, &batched);
+    std::filesystem::remove(log_path);
+}
+
+void BenchmarkAddDocuments(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 1000, 10);
+    std::vector<std::string> texts;
+    for (int i = 0; i < 20000; ++i) {
+        texts.push_back(generateQuery(generator, dictionary, 70));
+    }
+    std::vector<NewDocument> batch;
+    for (int i = 0; i < static_cast<int>(texts.size()); ++i) {
+        batch.push_back({ i, texts[i], DocumentStatus::ACTUAL, { 1, 2, 3 } });
+    }
+
+    out << "Documents: "s << batch.size() << std::endl;
+    SearchServer one_by_one(dictionary[0]);
+    {
+        LOG_DURATION_STREAM("  AddDocument"s, out);
+        for (const NewDocument& document : batch) {
+            one_by_one.AddDocument(document.id, document.text, document.status, document.ratings);
+        }
+    }
+    SearchServer batched(dictionary[0]);
+    {
+        LOG_DURATION_STREAM("  AddDocuments"s, out);
+        batched.AddDocuments(batch);
+    }
+    if (one_by_one.GetDocumentCount() != batched.GetDocumentCount()) {
+        out << "  document counts differ"s << std::endl;
+    }
+}
+
+void BenchmarkIngestCorpus(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 1000, 10);
+    const std::string path = (std::filesystem::temp_directory_path() / "search_server_benchmark.corpus"s).string();
+    const int document_count = 20000;
+    {
+        std::ofstream corpus(path, std::ios::binary | std::ios::trunc);
+        for (int i = 0; i < document_count; ++i) {
+            corpus << i << "\tACTUAL\t1 2 3\t"s << generateQuery(generator, dictionary, 70) << '\n';
+        }
+    }
+
+    out << "Documents: "s << document_count << std::endl;
+    SearchServer line_by_line(dictionary[0]);
+    {
+        LOG_DURATION_STREAM("  getline and AddDocument"s, out);
+        std::ifstream corpus(path, std::ios::binary);
+        std::string line;
+        while (std::getline(corpus, line)) {
+            const NewDocument document = ParseCorpusLine(line);
+            line_by_line.AddDocument(document.id, document.text, document.status, document.ratings);
+        }
+    }
+    SearchServer ingested(dictionary[0]);
+    {
+        LOG_DURATION_STREAM("  IngestCorpus"s, out);
+        IngestCorpus(ingested, path);
+    }
+    if (line_by_line.GetDocumentCount() != ingested.GetDocumentCount()) {
+        out << "  document counts differ"s << std::endl;
+    }
+    std::filesystem::remove(path);
+}
+
+void BenchmarkSplitIntoWords(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 1000, 10);
+    std::vector<std::string> texts;
+    for (int i = 0; i < 20000; ++i) {
+        texts.push_back(generateQuery(generator, dictionary, 70));
+    }
+
+    out << "Documents: "s << texts.size() << std::endl;
+    std::size_t word_count = 0;
+    std::vector<std::string_view> words;
+    {
+        LOG_DURATION_STREAM("  find_first_of and per-character check"s, out);
+        const std::string_view delimiters = " \r\n\t\v";
+        for (const std::string& text : texts) {
+            words.clear();
+            std::size_t begin = text.find_first_not_of(delimiters);
+            while (begin != std::string::npos) {
+                const std::size_t end = std::min(text.find_first_of(delimiters, begin), text.size());
+                words.push_back(std::string_view(text).substr(begin, end - begin));
+                begin = text.find_first_not_of(delimiters, end);
+            }
+            const bool is_valid = std::all_of(words.begin(), words.end(), [](std::string_view word) {
+                for (std::size_t i = 0; i < word.size(); ++i) {
+                    const char c = word[i];
+                    if (c >= 0 && (iscntrl(c) || !(i == 0 ? isalpha(c) : isgraph(c)))) {
+                        return false;
+                    }
+                }
+                return true;
+            });
+            word_count += is_valid ? words.size() : 0;
+        }
+    }
+    std::size_t split_word_count = 0;
+    {
+        LOG_DURATION_STREAM("  SplitIntoValidWords"s, out);
+        for (const std::string& text : texts) {
+            words.clear();
+            split_word_count += SplitIntoValidWords(text, words) ? words.size() : 0;
+        }
+    }
+    if (word_count != split_word_count) {
+        out << "  word counts differ"s << std::endl;
+    }
+}
+
+void BenchmarkTermDictionary(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 10000, 10);
+    std::vector<std::string> texts;
+    for (int i = 0; i < 20000; ++i) {
+        texts.push_back(generateQuery(generator, dictionary, 70));
+    }
+    std::vector<std::vector<std::string_view>> documents;
+    for (const std::string& text : texts) {
+        documents.push_back(SplitIntoWords(text));
+    }
+
+    out << "Documents: "s << documents.size() << ", words: "s << dictionary.size() << std::endl;
+    std::size_t word_count = 0;
+    {
+        LOG_DURATION_STREAM("  unordered_map and std::set"s, out);
+        std::unordered_map<std::string_view, TermId> term_ids;
+        std::set<TermId> stop_words;
+        for (int i = 0; i < 100; ++i) {
+            stop_words.insert(term_ids.emplace(dictionary[i * 10], static_cast<TermId>(term_ids.size())).first->second);
+        }
+        for (const auto& words : documents) {
+            for (const std::string_view word : words) {
+                const TermId term = term_ids.emplace(word, static_cast<TermId>(term_ids.size())).first->second;
+                word_count += stop_words.count(term) == 0;
+            }
+        }
+    }
+    std::size_t table_word_count = 0;
+    {
+        LOG_DURATION_STREAM("  TermDictionary and stop word bits"s, out);
+        TermDictionary terms;
+        std::vector<bool> stop_words;
+        for (int i = 0; i < 100; ++i) {
+            const TermId term = terms.Intern(dictionary[i * 10]);
+            stop_words.resize(term + 1);
+            stop_words[term] = true;
+        }
+        for (const auto& words : documents) {
+            for (const std::string_view word : words) {
+                const TermId term = terms.Intern(word);
+                table_word_count += term >= static_cast<TermId>(stop_words.size()) || !stop_words[term];
+            }
+        }
+    }
+    if (word_count != table_word_count) {
+        out << "  word counts differ"s << std::endl;
+    }
+}
+
+void BenchmarkRemoveDuplicates(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 1000, 10);
+    // Каждый четвёртый документ повторяет набор слов одного из предыдущих
+    const auto make_server = [&](int document_count) {
+        auto server = std::make_unique<SearchServer>(dictionary[0]);
+        std::vector<std::string> texts;
+        for (int i = 0; i < document_count; ++i) {
+            if (i % 4 == 3) {
+                texts.push_back(texts[std::uniform_int_distribution<int>(0, i - 1)(generator)]);
+            }
+            else {
+                texts.push_back(generateQuery(generator, dictionary, 20));
+            }
+            server->AddDocument(i, texts.back(), DocumentStatus::ACTUAL, { 1 });
+        }
+        return server;
+    };
+    for (const int document_count : { 2000, 100000 }) {
+        out << "Documents: "s << document_count << std::endl;
+        if (document_count <= 2000) {
+            const auto server = make_server(document_count);
+            LOG_DURATION_STREAM("  pairwise"s, out);
+            std::vector<int> duplicates;
+            for (int i = 0; i < document_count; ++i) {
+                const auto& rhs = server->GetWordFrequencies(server->GetDocumentId(i));
+                for (int j = 0; j < i; ++j) {
+                    const auto& lhs = server->GetWordFrequencies(server->GetDocumentId(j));
+                    if (lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const auto& l, const auto& r) { return l.first == r.first; })) {
+                        duplicates.push_back(server->GetDocumentId(i));
+                        break;
+                    }
+                }
+            }
+            for (const int document_id : duplicates) {
+                server->RemoveDocument(document_id);
+            }
+        }
+        const auto server = make_server(document_count);
+        LOG_DURATION_STREAM("  RemoveDuplicates"s, out);
+        // Сообщения об удалённых документах не выводятся
+        std::ostringstream log;
+        std::streambuf* const cout_buffer = std::cout.rdbuf(log.rdbuf());
+        RemoveDuplicates(*server);
+        std::cout.rdbuf(cout_buffer);
+    }
+}
+
+void BenchmarkNearDuplicates(std::ostream& out) {
+    using namespace std::string_literals;
+
+    std::mt19937 generator;
+    const auto dictionary = generateDictionary(generator, 5000, 10);
+    // Каждый четвёртый документ - копия одного из предыдущих с двумя заменёнными словами
+    const auto make_server = [&](int document_count) {
+        auto server = std::make_unique<SearchServer>();
+        std::vector<std::vector<std::string>> documents;
+        for (int i = 0; i < document_count; ++i) {
+            std::vector<std::string> words;
+            if (i % 4 == 3) {
+                words = documents[std::uniform_int_distribution<int>(0, i - 1)(generator)];
+                for (int change = 0; change < 2; ++change) {
+                    words[std::uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)] = generateWord(generator, 10);
+                }
+            }
+            else {
+                for (int j = 0; j < 40; ++j) {
+                    words.push_back(dictionary[std::uniform_int_distribution<int>(0, static_cast<int>(dictionary.size()) - 1)(generator)]);
+                }
+            }
+            std::string text;
+            for (const std::string& word : words) {
+                text += word + " "s;
+            }
+            server->AddDocument(i, text, DocumentStatus::ACTUAL, { 1 });
+            documents.push_back(std::move(words));
+        }
+        return server;
+    };
+
+    for (const int document_count : { 2000, 50000 }) {
+        const auto server = make_server(document_count);
+        out << "Documents: "s << document_count << std::endl;
+        if (document_count <= 2000) {
+            LOG_DURATION_STREAM("  pairwise Jaccard"s, out);
+            std::vector<std::vector<TermId>> terms;
+            for (const int document_id : *server) {
+                std::vector<TermId>& document_terms = terms.emplace_back();
+                for (const auto& [term, _] : server->GetWordFrequencies(document_id)) {
+                    document_terms.push_back(term);
+                }
+            }
+            int pair_count = 0;
+            std::vector<TermId> common;
+            for (std::size_t i = 0; i < terms.size(); ++i) {
+                for (std::size_t j = 0; j < i; ++j) {
+                    common.clear();
+                    std::set_intersection(terms[i].begin(), terms[i].end(), terms[j].begin(), terms[j].end(), std::back_inserter(common));
+                    pair_count += common.size() >= 0.8 * (terms[i].size() + terms[j].size() - common.size());
+                }
+            }
+            out << "  similar pairs: "s << pair_count << std::endl;
+        }
+        std::size_t group_count = 0;
+        {
+            LOG_DURATION_STREAM("  FindNearDuplicates"s, out);
+            group_count = FindNearDuplicates(*server).size();
+        }
+        out << "  groups: "s << group_count << std::endl;
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <iostream>
+
+// Сравнение последовательного и параллельного поиска на корпусах с растущей длиной списков вхождений
+void BenchmarkFindTopDocuments(std::ostream& out);
+
+// Сравнение поиска по пакету запросов в цикле и через ProcessQueries
+void BenchmarkProcessQueries(std::ostream& out);
+
+// Сравнение поиска по одному серверу и по серверу с шардами на том же корпусе
+void BenchmarkShardedSearchServer(std::ostream& out);
+
+// Сравнение построения индекса документами и загрузки того же индекса из файла
+void BenchmarkIndexFile(std::ostream& out);
+
+// Сравнение добавления документов без журнала, с fsync на каждый документ и с групповой записью журнала
+void BenchmarkWriteAheadLog(std::ostream& out);
+
+// Сравнение добавления документов по одному и одним пакетом
+void BenchmarkAddDocuments(std::ostream& out);
+
+// Сравнение загрузки корпуса через getline и AddDocument с конвейером IngestCorpus
+void BenchmarkIngestCorpus(std::ostream& out);
+
+// Сравнение разбора текстов поиском разделителей и посимвольной проверкой слов с разбором за один проход
+void BenchmarkSplitIntoWords(std::ostream& out);
+
+// Сравнение поиска слов текста в unordered_map и std::set стоп-слов с таблицей словаря и битами стоп-слов
+void BenchmarkTermDictionary(std::ostream& out);
+
+// Сравнение попарного поиска дубликатов с поиском по хешам наборов слов
+void BenchmarkRemoveDuplicates(std::ostream& out);
+
+// Сравнение попарного сравнения наборов слов с поиском почти одинаковых документов по MinHash и LSH
+void BenchmarkNearDuplicates(std::ostream& out);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+// Очередь между стадиями конвейера. Push ждёт, пока в очереди есть место, Pop - пока есть элемент,
+// поэтому быстрая стадия не уходит вперёд медленной больше чем на capacity элементов.
+// После Close очередь отдаёт оставшиеся элементы, а Push больше ничего не принимает
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity_(capacity == 0 ? 1 : capacity) {
+    }
+
+    // false, если очередь закрыта и элемент не принят
+    bool Push(T value) {
+        std::unique_lock lock(mutex_);
+        not_full_.wait(lock, [this]() {
+            return closed_ || items_.size() < capacity_;
+        });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(value));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    // Пусто, если очередь закрыта и все элементы разобраны
+    std::optional<T> Pop() {
+        std::unique_lock lock(mutex_);
+        not_empty_.wait(lock, [this]() {
+            return closed_ || !items_.empty();
+        });
+        if (items_.empty()) {
+            return std::nullopt;
+        }
+        T value = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return value;
+    }
+
+    void Close() {
+        std::lock_guard guard(mutex_);
+        closed_ = true;
+        not_full_.notify_all();
+        not_empty_.notify_all();
+    }
+
+private:
+    std::size_t capacity_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+    std::deque<T> items_;
+    bool closed_ = false;
+};
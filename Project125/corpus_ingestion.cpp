@@ -0,0 +1,208 @@
+#include "corpus_ingestion.h"
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bounded_queue.h"
+
+namespace {
+
+// Блок файла и документы, тексты которых ссылаются на него
+struct CorpusBlock {
+    std::unique_ptr<std::string> data;
+    std::vector<NewDocument> documents;
+    std::vector<SearchIndex::PartialIndex> partials;
+};
+
+std::string_view nextField(std::string_view& line) {
+    const std::size_t end = line.find('\t');
+    if (end == std::string_view::npos) {
+        throw std::invalid_argument("Bad corpus line");
+    }
+    const std::string_view field = line.substr(0, end);
+    line.remove_prefix(end + 1);
+    return field;
+}
+
+int parseNumber(std::string_view text) {
+    int value = 0;
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (error != std::errc() || end != text.data() + text.size() || text.empty()) {
+        throw std::invalid_argument("Bad corpus line");
+    }
+    return value;
+}
+
+DocumentStatus parseStatus(std::string_view text) {
+    static const std::pair<std::string_view, DocumentStatus> names[] = {
+        { "ACTUAL", DocumentStatus::ACTUAL },
+        { "IRRELEVANT", DocumentStatus::IRRELEVANT },
+        { "BANNED", DocumentStatus::BANNED },
+        { "REMOVED", DocumentStatus::REMOVED },
+    };
+    for (const auto& [name, status] : names) {
+        if (text == name) {
+            return status;
+        }
+    }
+    const int number = parseNumber(text);
+    if (number < static_cast<int>(DocumentStatus::ACTUAL) || number > static_cast<int>(DocumentStatus::REMOVED)) {
+        throw std::invalid_argument("Bad corpus line");
+    }
+    return static_cast<DocumentStatus>(number);
+}
+
+// Читает блок, который заканчивается на границе строки. Хвост неполной строки переходит в следующий блок
+class BlockReader {
+public:
+    BlockReader(const std::string& path, std::size_t block_size) : in_(path, std::ios::binary), block_size_(block_size == 0 ? 1 : block_size) {
+        if (!in_) {
+            throw std::runtime_error("Cannot open corpus file " + path);
+        }
+    }
+
+    std::unique_ptr<std::string> Read() {
+        auto block = std::make_unique<std::string>(std::move(tail_));
+        tail_.clear();
+        while (!eof_) {
+            const std::size_t size = block->size();
+            block->resize(size + block_size_);
+            in_.read(block->data() + size, static_cast<std::streamsize>(block_size_));
+            block->resize(size + static_cast<std::size_t>(in_.gcount()));
+            if (in_.bad()) {
+                throw std::runtime_error("Cannot read corpus file");
+            }
+            eof_ = in_.eof();
+            // Строка длиннее блока читается дальше, пока не встретится её конец
+            const std::size_t line_end = block->find_last_of('\n');
+            if (line_end != std::string::npos && line_end >= size) {
+                tail_.assign(*block, line_end + 1);
+                block->resize(line_end + 1);
+                break;
+            }
+        }
+        return block;
+    }
+
+    bool AtEnd() const {
+        return eof_ && tail_.empty();
+    }
+
+private:
+    std::ifstream in_;
+    std::size_t block_size_;
+    std::string tail_;
+    bool eof_ = false;
+};
+
+}
+
+NewDocument ParseCorpusLine(std::string_view line) {
+    NewDocument document;
+    document.id = parseNumber(nextField(line));
+    document.status = parseStatus(nextField(line));
+    std::string_view ratings = nextField(line);
+    while (!ratings.empty()) {
+        const std::size_t end = std::min(ratings.find(' '), ratings.size());
+        if (end > 0) {
+            document.ratings.push_back(parseNumber(ratings.substr(0, end)));
+        }
+        ratings.remove_prefix(std::min(end + 1, ratings.size()));
+    }
+    document.text = line;
+    return document;
+}
+
+int IngestCorpus(SearchServer& search_server, const std::string& path, const IngestionOptions& options) {
+    BlockReader reader(path, options.block_size);
+    BoundedQueue<CorpusBlock> read_blocks(options.queue_capacity);
+    BoundedQueue<CorpusBlock> prepared_blocks(options.queue_capacity);
+    std::exception_ptr reader_error;
+    std::exception_ptr tokenizer_error;
+
+    // Стадия чтения: блоки файла разбиваются на строки документов
+    std::thread reader_thread([&]() {
+        try {
+            int line_number = 0;
+            while (!reader.AtEnd()) {
+                CorpusBlock block;
+                block.data = reader.Read();
+                std::string_view data = *block.data;
+                while (!data.empty()) {
+                    const std::size_t end = std::min(data.find('\n'), data.size());
+                    std::string_view line = data.substr(0, end);
+                    data.remove_prefix(std::min(end + 1, data.size()));
+                    ++line_number;
+                    if (!line.empty() && line.back() == '\r') {
+                        line.remove_suffix(1);
+                    }
+                    if (line.empty()) {
+                        continue;
+                    }
+                    try {
+                        block.documents.push_back(ParseCorpusLine(line));
+                    }
+                    catch (const std::invalid_argument&) {
+                        throw std::invalid_argument("Bad corpus line " + std::to_string(line_number));
+                    }
+                }
+                if (block.documents.empty()) {
+                    continue;
+                }
+                if (!read_blocks.Push(std::move(block))) {
+                    break;
+                }
+            }
+        }
+        catch (...) {
+            reader_error = std::current_exception();
+        }
+        read_blocks.Close();
+    });
+
+    // Стадия разбора: слова блока разбираются параллельно, по части блока на поток
+    std::thread tokenizer_thread([&]() {
+        try {
+            while (std::optional<CorpusBlock> block = read_blocks.Pop()) {
+                block->partials = SearchIndex::PrepareDocuments(block->documents);
+                if (!prepared_blocks.Push(std::move(*block))) {
+                    break;
+                }
+            }
+        }
+        catch (...) {
+            tokenizer_error = std::current_exception();
+        }
+        prepared_blocks.Close();
+    });
+
+    // Стадия индексации в вызывающем потоке: пока блок сливается в индекс, следующие читаются и разбираются
+    int document_count = 0;
+    std::exception_ptr index_error;
+    try {
+        while (std::optional<CorpusBlock> block = prepared_blocks.Pop()) {
+            search_server.AddPreparedDocuments(block->documents, std::move(block->partials));
+            document_count += static_cast<int>(block->documents.size());
+        }
+    }
+    catch (...) {
+        index_error = std::current_exception();
+    }
+    read_blocks.Close();
+    prepared_blocks.Close();
+    reader_thread.join();
+    tokenizer_thread.join();
+    for (const std::exception_ptr& error : { reader_error, tokenizer_error, index_error }) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return document_count;
+}
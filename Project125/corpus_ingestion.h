@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include "search_index.h"
+#include "search_server.h"
+
+// Корпус - текстовый файл, строка на документ: id, статус, оценки через пробел и текст, разделённые табуляцией.
+// Статус - имя из DocumentStatus или его номер, оценок может не быть. Пустые строки пропускаются
+struct IngestionOptions {
+    // Файл читается блоками такого размера, строка не делится между блоками
+    std::size_t block_size = 4 << 20;
+    // Сколько блоков может ждать в каждой очереди между стадиями
+    std::size_t queue_capacity = 4;
+};
+
+// Разбирает строку корпуса. Текст документа ссылается на line. Неверная строка - std::invalid_argument
+NewDocument ParseCorpusLine(std::string_view line);
+
+// Добавляет документы корпуса конвейером из трёх стадий: чтение блоков, параллельный разбор блока на слова
+// и добавление в индекс. Стадии связаны ограниченными очередями, поэтому в памяти не больше нескольких блоков.
+// Блоки добавляются в порядке файла, блок с ошибкой не добавляется, а исключение прерывает загрузку:
+// std::invalid_argument для неверной строки или документа, std::runtime_error при ошибке чтения.
+// Возвращает число добавленных документов
+int IngestCorpus(SearchServer& search_server, const std::string& path, const IngestionOptions& options = {});
@@ -0,0 +1,117 @@
+#include "corpus_statistics.h"
+
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+
+#include "index_file.h"
+
+CorpusStatistics::CorpusStatistics(const CorpusStatistics& other) {
+    *this = other;
+}
+
+CorpusStatistics& CorpusStatistics::operator=(const CorpusStatistics& other) {
+    if (this != &other) {
+        other.refresh();
+        document_count_ = other.document_count_;
+        document_freqs_ = other.document_freqs_;
+        stale_terms_.clear();
+        is_stale_term_.assign(other.is_stale_term_.size(), false);
+        log_document_count_ = other.log_document_count_;
+        log_document_freqs_ = other.log_document_freqs_;
+        is_stale_.store(false, std::memory_order_release);
+    }
+    return *this;
+}
+
+CorpusStatistics::CorpusStatistics(CorpusStatistics&& other) {
+    *this = std::move(other);
+}
+
+CorpusStatistics& CorpusStatistics::operator=(CorpusStatistics&& other) {
+    if (this != &other) {
+        document_count_ = other.document_count_;
+        document_freqs_ = std::move(other.document_freqs_);
+        stale_terms_ = std::move(other.stale_terms_);
+        is_stale_term_ = std::move(other.is_stale_term_);
+        log_document_count_ = other.log_document_count_;
+        log_document_freqs_ = std::move(other.log_document_freqs_);
+        is_stale_.store(other.is_stale_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+    return *this;
+}
+
+void CorpusStatistics::Resize(int term_count) {
+    document_freqs_.resize(term_count);
+    is_stale_term_.resize(term_count);
+    log_document_freqs_.resize(term_count);
+}
+
+void CorpusStatistics::AddDocument(const std::vector<TermId>& terms) {
+    ++document_count_;
+    for (const TermId term : terms) {
+        ++document_freqs_[term];
+        markStale(term);
+    }
+    is_stale_.store(true, std::memory_order_release);
+}
+
+void CorpusStatistics::RemoveDocument(const std::vector<TermId>& terms) {
+    --document_count_;
+    for (const TermId term : terms) {
+        --document_freqs_[term];
+        markStale(term);
+    }
+    is_stale_.store(true, std::memory_order_release);
+}
+
+int CorpusStatistics::GetDocumentCount() const {
+    return document_count_;
+}
+
+void CorpusStatistics::Save(SectionWriter& out) const {
+    out.Write<int64_t>(document_count_);
+    out.Write<uint64_t>(document_freqs_.size());
+    out.WriteArray(document_freqs_.data(), document_freqs_.size());
+}
+
+void CorpusStatistics::Load(SectionReader& in) {
+    const int64_t document_count = in.Read<int64_t>();
+    const uint64_t term_count = in.Read<uint64_t>();
+    const int* document_freqs = in.ReadArray<int>(term_count);
+    document_count_ = static_cast<int>(document_count);
+    document_freqs_.assign(document_freqs, document_freqs + term_count);
+    is_stale_term_.assign(term_count, true);
+    log_document_freqs_.assign(term_count, 0.0);
+    stale_terms_.resize(term_count);
+    std::iota(stale_terms_.begin(), stale_terms_.end(), 0);
+    is_stale_.store(true, std::memory_order_release);
+}
+
+double CorpusStatistics::ComputeInverseDocumentFreq(int document_count, int document_freq) {
+    const double log_document_count = document_count > 0 ? std::log(document_count) : 0.0;
+    const double log_document_freq = document_freq > 0 ? std::log(document_freq) : 0.0;
+    return log_document_count - log_document_freq;
+}
+
+void CorpusStatistics::markStale(TermId term) {
+    if (!is_stale_term_[term]) {
+        is_stale_term_[term] = true;
+        stale_terms_.push_back(term);
+    }
+}
+
+void CorpusStatistics::refresh() const {
+    std::lock_guard guard(refresh_mutex_);
+    if (!is_stale_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    log_document_count_ = document_count_ > 0 ? std::log(document_count_) : 0.0;
+    for (const TermId term : stale_terms_) {
+        log_document_freqs_[term] = document_freqs_[term] > 0 ? std::log(document_freqs_[term]) : 0.0;
+        is_stale_term_[term] = false;
+    }
+    stale_terms_.clear();
+    is_stale_.store(false, std::memory_order_release);
+}
\ No newline at end of file
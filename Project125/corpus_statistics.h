@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "term_dictionary.h"
+
+class SectionReader;
+class SectionWriter;
+
+// Статистика корпуса: число документов и документная частота каждого слова.
+// IDF хранится как log(N) - log(df): при изменении df пересчитывается логарифм только этого слова,
+// и пересчёт откладывается до первого запроса после пачки изменений
+class CorpusStatistics {
+public:
+    CorpusStatistics() = default;
+    CorpusStatistics(const CorpusStatistics& other);
+    CorpusStatistics& operator=(const CorpusStatistics& other);
+    // Перенос не считает логарифмы: слова с изменившейся частотой переходят вместе со статистикой
+    CorpusStatistics(CorpusStatistics&& other);
+    CorpusStatistics& operator=(CorpusStatistics&& other);
+
+    void Resize(int term_count);
+
+    void AddDocument(const std::vector<TermId>& terms);
+    void RemoveDocument(const std::vector<TermId>& terms);
+
+    int GetDocumentCount() const;
+    int GetDocumentFrequency(TermId term) const {
+        return document_freqs_[term];
+    }
+
+    double GetInverseDocumentFreq(TermId term) const {
+        if (is_stale_.load(std::memory_order_acquire)) {
+            refresh();
+        }
+        return log_document_count_ - log_document_freqs_[term];
+    }
+
+    void Save(SectionWriter& out) const;
+    // Логарифмы загруженных частот считаются при первом запросе IDF
+    void Load(SectionReader& in);
+
+    // IDF по той же формуле для статистики, собранной вне этого объекта
+    static double ComputeInverseDocumentFreq(int document_count, int document_freq);
+
+private:
+    int document_count_ = 0;
+    std::vector<int> document_freqs_;
+
+    // Очередь слов с изменившейся частотой разбирается при первом чтении IDF под мьютексом
+    mutable std::mutex refresh_mutex_;
+    mutable std::vector<TermId> stale_terms_;
+    mutable std::vector<bool> is_stale_term_;
+    mutable std::atomic<bool> is_stale_ = false;
+    mutable double log_document_count_ = 0.0;
+    mutable std::vector<double> log_document_freqs_;
+
+    void markStale(TermId term);
+    void refresh() const;
+};
\ No newline at end of file
@@ -0,0 +1,164 @@
+#include "document_table.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "index_file.h"
+
+DocumentTable::const_iterator DocumentTable::begin() const {
+    return const_iterator(&id_blocks_, 0);
+}
+
+DocumentTable::const_iterator DocumentTable::end() const {
+    return const_iterator(&id_blocks_, id_blocks_.size());
+}
+
+int DocumentTable::size() const {
+    return block_ends_.empty() ? 0 : block_ends_.back();
+}
+
+bool DocumentTable::empty() const {
+    return id_blocks_.empty();
+}
+
+int DocumentTable::Add(int document_id, int rating, DocumentStatus status, int word_count) {
+    int slot;
+    if (free_slots_.empty()) {
+        slot = static_cast<int>(slot_document_ids_.size());
+        slot_document_ids_.push_back(document_id);
+        ratings_.push_back(rating);
+        statuses_.push_back(status);
+        word_counts_.push_back(word_count);
+        segments_.push_back(0);
+    }
+    else {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        slot_document_ids_[slot] = document_id;
+        ratings_[slot] = rating;
+        statuses_[slot] = status;
+        word_counts_[slot] = word_count;
+        segments_[slot] = 0;
+    }
+    slots_.emplace(document_id, slot);
+
+    if (id_blocks_.empty()) {
+        id_blocks_.push_back({ document_id });
+        block_ends_.push_back(1);
+        return slot;
+    }
+    const std::size_t block_index = findBlock(document_id);
+    std::vector<int>& block = id_blocks_[block_index];
+    block.insert(std::lower_bound(block.begin(), block.end(), document_id), document_id);
+    if (block.size() > MAX_BLOCK_SIZE) {
+        std::vector<int> upper(block.begin() + block.size() / 2, block.end());
+        block.resize(block.size() / 2);
+        id_blocks_.insert(id_blocks_.begin() + block_index + 1, std::move(upper));
+        block_ends_.insert(block_ends_.begin() + block_index + 1, 0);
+    }
+    updateBlockEnds(block_index);
+    return slot;
+}
+
+bool DocumentTable::Remove(int document_id) {
+    const auto it = slots_.find(document_id);
+    if (it == slots_.end()) {
+        return false;
+    }
+    slot_document_ids_[it->second] = -1;
+    free_slots_.push_back(it->second);
+    slots_.erase(it);
+
+    const std::size_t block_index = findBlock(document_id);
+    std::vector<int>& block = id_blocks_[block_index];
+    block.erase(std::lower_bound(block.begin(), block.end(), document_id));
+    if (block.empty()) {
+        id_blocks_.erase(id_blocks_.begin() + block_index);
+        block_ends_.erase(block_ends_.begin() + block_index);
+    }
+    updateBlockEnds(block_index);
+    return true;
+}
+
+bool DocumentTable::Contains(int document_id) const {
+    return slots_.count(document_id) > 0;
+}
+
+int DocumentTable::FindSlot(int document_id) const {
+    const auto it = slots_.find(document_id);
+    return it == slots_.end() ? NO_SLOT : it->second;
+}
+
+int DocumentTable::GetIdAt(int index) const {
+    if (index < 0 || index >= size()) {
+        throw std::out_of_range("index is more than a documents count");
+    }
+    const std::size_t block_index = std::upper_bound(block_ends_.begin(), block_ends_.end(), index) - block_ends_.begin();
+    const int block_begin = block_index == 0 ? 0 : block_ends_[block_index - 1];
+    return id_blocks_[block_index][index - block_begin];
+}
+
+int DocumentTable::GetSlotCount() const {
+    return static_cast<int>(slot_document_ids_.size());
+}
+
+void DocumentTable::Save(SectionWriter& out) const {
+    std::vector<int> ratings;
+    std::vector<int> statuses;
+    std::vector<int> word_counts;
+    const std::vector<int> document_ids(begin(), end());
+    for (const int document_id : document_ids) {
+        const int slot = FindSlot(document_id);
+        ratings.push_back(ratings_[slot]);
+        statuses.push_back(static_cast<int>(statuses_[slot]));
+        word_counts.push_back(word_counts_[slot]);
+    }
+    out.Write<uint64_t>(document_ids.size());
+    out.WriteArray(document_ids.data(), document_ids.size());
+    out.WriteArray(ratings.data(), ratings.size());
+    out.WriteArray(statuses.data(), statuses.size());
+    out.WriteArray(word_counts.data(), word_counts.size());
+}
+
+void DocumentTable::Load(SectionReader& in, int segment) {
+    const uint64_t count = in.Read<uint64_t>();
+    const int* document_ids = in.ReadArray<int>(count);
+    const int* ratings = in.ReadArray<int>(count);
+    const int* statuses = in.ReadArray<int>(count);
+    const int* word_counts = in.ReadArray<int>(count);
+    *this = DocumentTable();
+    slot_document_ids_.assign(document_ids, document_ids + count);
+    ratings_.assign(ratings, ratings + count);
+    word_counts_.assign(word_counts, word_counts + count);
+    segments_.assign(count, segment);
+    statuses_.reserve(count);
+    slots_.reserve(count);
+    for (uint64_t slot = 0; slot < count; ++slot) {
+        if (slot > 0 && document_ids[slot] <= document_ids[slot - 1]) {
+            throw std::runtime_error("Bad index file: document ids are not sorted");
+        }
+        statuses_.push_back(static_cast<DocumentStatus>(statuses[slot]));
+        slots_.emplace(document_ids[slot], static_cast<int>(slot));
+    }
+    // Загруженные блоки заполнены наполовину, чтобы первые добавления не делили их
+    for (uint64_t first = 0; first < count; first += MAX_BLOCK_SIZE / 2) {
+        const uint64_t last = std::min<uint64_t>(count, first + MAX_BLOCK_SIZE / 2);
+        id_blocks_.emplace_back(document_ids + first, document_ids + last);
+        block_ends_.push_back(static_cast<int>(last));
+    }
+}
+
+std::size_t DocumentTable::findBlock(int document_id) const {
+    const auto it = std::partition_point(id_blocks_.begin(), id_blocks_.end() - 1, [document_id](const std::vector<int>& block) {
+        return block.back() < document_id;
+    });
+    return it - id_blocks_.begin();
+}
+
+void DocumentTable::updateBlockEnds(std::size_t first_block) {
+    int end = first_block == 0 ? 0 : block_ends_[first_block - 1];
+    for (std::size_t block = first_block; block < id_blocks_.size(); ++block) {
+        end += static_cast<int>(id_blocks_[block].size());
+        block_ends_[block] = end;
+    }
+}
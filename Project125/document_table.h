@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+#include "document.h"
+
+class SectionReader;
+class SectionWriter;
+
+// Таблица документов: данные лежат по столбцам в плотных массивах слотов,
+// id документа переводится в слот через хеш-таблицу, а отсортированные id хранятся блоками
+// не длиннее MAX_BLOCK_SIZE с числом id до конца каждого блока. Добавление и удаление сдвигают
+// один блок и пересчитывают концы блоков, то есть стоят O(B + N / B), а не O(N), документ
+// по порядковому номеру находится двоичным поиском по концам блоков
+class DocumentTable {
+public:
+    static constexpr int NO_SLOT = -1;
+
+    // Обход id по возрастанию
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = const int&;
+
+        const_iterator() = default;
+
+        reference operator*() const {
+            return (*blocks_)[block_][index_];
+        }
+
+        pointer operator->() const {
+            return &**this;
+        }
+
+        const_iterator& operator++() {
+            if (++index_ == (*blocks_)[block_].size()) {
+                ++block_;
+                index_ = 0;
+            }
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return block_ == other.block_ && index_ == other.index_;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class DocumentTable;
+
+        const_iterator(const std::vector<std::vector<int>>* blocks, std::size_t block)
+            : blocks_(blocks), block_(block) {
+        }
+
+        const std::vector<std::vector<int>>* blocks_ = nullptr;
+        std::size_t block_ = 0;
+        std::size_t index_ = 0;
+    };
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    int size() const;
+    bool empty() const;
+
+    int Add(int document_id, int rating, DocumentStatus status, int word_count);
+    bool Remove(int document_id);
+
+    bool Contains(int document_id) const;
+    int FindSlot(int document_id) const;
+    int GetIdAt(int index) const;
+    int GetSlotCount() const;
+
+    int GetDocumentId(int slot) const {
+        return slot_document_ids_[slot];
+    }
+
+    int GetRating(int slot) const {
+        return ratings_[slot];
+    }
+
+    DocumentStatus GetStatus(int slot) const {
+        return statuses_[slot];
+    }
+
+    int GetWordCount(int slot) const {
+        return word_counts_[slot];
+    }
+
+    // Сегмент индекса, в котором лежат действующие вхождения документа
+    int GetSegment(int slot) const {
+        return segments_[slot];
+    }
+
+    void SetSegment(int slot, int segment) {
+        segments_[slot] = segment;
+    }
+
+    // Документы записываются по возрастанию id и при загрузке занимают слоты с нулевого по порядку
+    void Save(SectionWriter& out) const;
+    void Load(SectionReader& in, int segment);
+
+private:
+    // Переполненный блок делится пополам, поэтому в блоке от 1 до MAX_BLOCK_SIZE id
+    static constexpr std::size_t MAX_BLOCK_SIZE = 512;
+
+    std::vector<int> slot_document_ids_;
+    std::vector<int> ratings_;
+    std::vector<DocumentStatus> statuses_;
+    std::vector<int> word_counts_;
+    std::vector<int> segments_;
+    std::vector<int> free_slots_;
+    std::unordered_map<int, int> slots_;
+    std::vector<std::vector<int>> id_blocks_;
+    // block_ends_[i] - число id в блоках с нулевого по i-й
+    std::vector<int> block_ends_;
+
+    // Блок, в котором лежит или должен лежать document_id
+    std::size_t findBlock(int document_id) const;
+    void updateBlockEnds(std::size_t first_block);
+};
@@ -0,0 +1,55 @@
+#include "frequency_sketch.h"
+
+#include <algorithm>
+
+static const uint64_t ROW_SEEDS[] = { 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull };
+
+FrequencySketch::FrequencySketch(std::size_t capacity) {
+    std::size_t width = 16;
+    while (width < capacity * 2) {
+        width *= 2;
+    }
+    counters_.assign(width * DEPTH / 2, 0);
+    mask_ = width - 1;
+    sample_size_ = std::max<std::size_t>(capacity, 1) * 10;
+}
+
+void FrequencySketch::Increment(uint64_t hash) {
+    bool added = false;
+    for (int row = 0; row < DEPTH; ++row) {
+        const std::size_t index = getIndex(hash, row);
+        uint8_t& pair = counters_[index / 2];
+        const int shift = static_cast<int>(index % 2) * 4;
+        if (((pair >> shift) & MAX_COUNT) < MAX_COUNT) {
+            pair = static_cast<uint8_t>(pair + (1 << shift));
+            added = true;
+        }
+    }
+    if (added && ++additions_ == sample_size_) {
+        reset();
+    }
+}
+
+int FrequencySketch::Estimate(uint64_t hash) const {
+    int estimate = MAX_COUNT;
+    for (int row = 0; row < DEPTH; ++row) {
+        const std::size_t index = getIndex(hash, row);
+        const int shift = static_cast<int>(index % 2) * 4;
+        estimate = std::min(estimate, (counters_[index / 2] >> shift) & MAX_COUNT);
+    }
+    return estimate;
+}
+
+std::size_t FrequencySketch::getIndex(uint64_t hash, int row) const {
+    uint64_t mixed = (hash + ROW_SEEDS[row]) * ROW_SEEDS[(row + 1) % DEPTH];
+    mixed ^= mixed >> 32;
+    return row * (mask_ + 1) + (mixed & mask_);
+}
+
+void FrequencySketch::reset() {
+    // Оба счётчика байта делятся пополам одним сдвигом; маска убирает бит, перешедший из старшего в младший
+    for (uint8_t& pair : counters_) {
+        pair = static_cast<uint8_t>((pair >> 1) & 0x77);
+    }
+    additions_ /= 2;
+}
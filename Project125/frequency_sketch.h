@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Приблизительный счётчик частот обращений (count-min sketch с 4-битными счётчиками).
+// Раз в sample_size инкрементов все счётчики делятся пополам, чтобы старые обращения забывались
+class FrequencySketch {
+public:
+    explicit FrequencySketch(std::size_t capacity);
+
+    void Increment(uint64_t hash);
+    int Estimate(uint64_t hash) const;
+
+private:
+    static const int DEPTH = 4;
+    static const uint8_t MAX_COUNT = 15;
+
+    // Два 4-битных счётчика в байте: чётный индекс - младшая половина, нечётный - старшая
+    std::vector<uint8_t> counters_;
+    std::size_t mask_;
+    std::size_t sample_size_;
+    std::size_t additions_ = 0;
+
+    std::size_t getIndex(uint64_t hash, int row) const;
+    void reset();
+};
\ No newline at end of file
@@ -0,0 +1,254 @@
+#include "index_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char INDEX_FILE_MAGIC[8] = { 'Y', 'S', 'S', 'I', 'N', 'D', 'E', 'X' };
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t section_count;
+    uint32_t reserved;
+    uint64_t file_size;
+    uint64_t checksum;
+};
+
+struct SectionEntry {
+    uint32_t id;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t checksum;
+};
+
+// Контрольная сумма заголовка считается по заголовку с нулевым полем checksum и таблице разделов
+uint64_t computeHeaderChecksum(FileHeader header, const SectionEntry* entries) {
+    header.checksum = 0;
+    std::string bytes(reinterpret_cast<const char*>(&header), sizeof(header));
+    bytes.append(reinterpret_cast<const char*>(entries), sizeof(SectionEntry) * header.section_count);
+    return ComputeChecksum(bytes.data(), bytes.size());
+}
+
+// Дожидается записи на диск содержимого файла или каталога. В Windows каталоги не синхронизируются,
+// переименование там и так записывается в журнал файловой системы
+bool syncPath(const std::string& path, bool is_directory) {
+#ifdef _WIN32
+    if (is_directory) {
+        return true;
+    }
+    const HANDLE handle = CreateFileA(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    const bool synced = FlushFileBuffers(handle) != 0;
+    CloseHandle(handle);
+    return synced;
+#else
+    const int descriptor = open(path.c_str(), is_directory ? O_RDONLY | O_DIRECTORY : O_RDONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+    const bool synced = fsync(descriptor) == 0;
+    close(descriptor);
+    return synced;
+#endif
+}
+
+std::size_t alignOffset(std::size_t offset) {
+    return (offset + SectionWriter::ALIGNMENT - 1) / SectionWriter::ALIGNMENT * SectionWriter::ALIGNMENT;
+}
+
+}
+
+std::shared_ptr<const IndexFile> IndexFile::Open(const std::string& path, bool verify_checksums) {
+    std::shared_ptr<IndexFile> file(new IndexFile());
+    file->map(path);
+    file->readHeader(verify_checksums);
+    return file;
+}
+
+IndexFile::~IndexFile() {
+#ifdef _WIN32
+    if (data_ != nullptr) {
+        UnmapViewOfFile(data_);
+    }
+    if (mapping_ != nullptr) {
+        CloseHandle(mapping_);
+    }
+#else
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
+
+bool IndexFile::HasSection(IndexSection id) const {
+    return std::any_of(sections_.begin(), sections_.end(), [id](const auto& section) {
+        return section.first == id;
+    });
+}
+
+IndexFile::Section IndexFile::GetSection(IndexSection id) const {
+    for (const auto& [section_id, section] : sections_) {
+        if (section_id == id) {
+            return section;
+        }
+    }
+    throw std::runtime_error("Bad index file: section is missing");
+}
+
+void IndexFile::map(const std::string& path) {
+#ifdef _WIN32
+    const HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open index file " + path);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader))) {
+        CloseHandle(handle);
+        throw std::runtime_error("Bad index file: file is truncated");
+    }
+    mapping_ = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(handle);
+    if (mapping_ == nullptr) {
+        throw std::runtime_error("Cannot map index file " + path);
+    }
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_ == nullptr) {
+        throw std::runtime_error("Cannot map index file " + path);
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+#else
+    const int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        throw std::runtime_error("Cannot open index file " + path);
+    }
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        close(descriptor);
+        throw std::runtime_error("Bad index file: file is truncated");
+    }
+    void* data = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Cannot map index file " + path);
+    }
+    data_ = static_cast<const char*>(data);
+    size_ = static_cast<std::size_t>(status.st_size);
+#endif
+}
+
+void IndexFile::readHeader(bool verify_checksums) {
+    FileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, INDEX_FILE_MAGIC, sizeof(INDEX_FILE_MAGIC)) != 0) {
+        throw std::runtime_error("Bad index file: unknown format");
+    }
+    if (header.version != INDEX_FILE_VERSION) {
+        throw std::runtime_error("Bad index file: unsupported version");
+    }
+    if (header.byte_order != BYTE_ORDER_MARK) {
+        throw std::runtime_error("Bad index file: byte order mismatch");
+    }
+    if (header.file_size != size_ || header.section_count > (size_ - sizeof(header)) / sizeof(SectionEntry)) {
+        throw std::runtime_error("Bad index file: file is truncated");
+    }
+    const auto* entries = reinterpret_cast<const SectionEntry*>(data_ + sizeof(header));
+    if (computeHeaderChecksum(header, entries) != header.checksum) {
+        throw std::runtime_error("Bad index file: header checksum mismatch");
+    }
+    for (uint32_t i = 0; i < header.section_count; ++i) {
+        const SectionEntry& entry = entries[i];
+        if (entry.offset % SectionWriter::ALIGNMENT != 0 || entry.offset > size_ || entry.size > size_ - entry.offset) {
+            throw std::runtime_error("Bad index file: section is out of file");
+        }
+        const Section section{ data_ + entry.offset, static_cast<std::size_t>(entry.size) };
+        if (verify_checksums && ComputeChecksum(section.data, section.size) != entry.checksum) {
+            throw std::runtime_error("Bad index file: section checksum mismatch");
+        }
+        sections_.emplace_back(static_cast<IndexSection>(entry.id), section);
+    }
+}
+
+std::string& IndexFileWriter::AddSection(IndexSection id) {
+    return sections_.emplace_back(id, std::string()).second;
+}
+
+void IndexFileWriter::Write(const std::string& path) const {
+    FileHeader header{};
+    std::memcpy(header.magic, INDEX_FILE_MAGIC, sizeof(INDEX_FILE_MAGIC));
+    header.version = INDEX_FILE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.section_count = static_cast<uint32_t>(sections_.size());
+
+    std::vector<SectionEntry> entries;
+    std::size_t offset = alignOffset(sizeof(FileHeader) + sizeof(SectionEntry) * sections_.size());
+    for (const auto& [id, bytes] : sections_) {
+        entries.push_back({ static_cast<uint32_t>(id), 0, offset, bytes.size(), ComputeChecksum(bytes.data(), bytes.size()) });
+        offset = alignOffset(offset + bytes.size());
+    }
+    header.file_size = offset;
+    header.checksum = computeHeaderChecksum(header, entries.data());
+
+    // Файл пишется рядом и переименовывается: отображённый в память прежний файл нельзя обрезать
+    const std::string temporary_path = path + ".tmp";
+    std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot write index file " + path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), sizeof(SectionEntry) * entries.size());
+    std::size_t written = sizeof(FileHeader) + sizeof(SectionEntry) * entries.size();
+    for (std::size_t i = 0; i < sections_.size(); ++i) {
+        const std::string padding(entries[i].offset - written, '\0');
+        out.write(padding.data(), padding.size());
+        out.write(sections_[i].second.data(), sections_[i].second.size());
+        written = entries[i].offset + sections_[i].second.size();
+    }
+    const std::string padding(header.file_size - written, '\0');
+    out.write(padding.data(), padding.size());
+    out.close();
+    std::error_code error;
+    if (!out || !syncPath(temporary_path, false) || (std::filesystem::rename(temporary_path, path, error), error)) {
+        std::filesystem::remove(temporary_path, error);
+        throw std::runtime_error("Cannot write index file " + path);
+    }
+    const std::filesystem::path directory = std::filesystem::absolute(path).parent_path();
+    if (!syncPath(directory.string(), true)) {
+        throw std::runtime_error("Cannot write index file " + path);
+    }
+}
+
+// FNV-1a по 64-битным словам: файл читается с той же скоростью, что и копируется
+uint64_t ComputeChecksum(const char* data, std::size_t size) {
+    const uint64_t prime = 0x100000001B3ull;
+    uint64_t hash = 0xCBF29CE484222325ull;
+    std::size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(data[i])) * prime;
+    }
+    return hash;
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+const uint32_t INDEX_FILE_VERSION = 2;
+
+enum class IndexSection : uint32_t {
+    STOP_WORDS = 1,
+    DICTIONARY = 2,
+    DOCUMENTS = 3,
+    STATISTICS = 4,
+    POSTINGS = 5,
+    WORD_FREQUENCIES = 6,
+    // Номер последней записи журнала изменений, которая вошла в снимок
+    LOG_SEQUENCE = 7,
+};
+
+// Файл индекса, отображённый в память только для чтения. Заголовок хранит версию формата, порядок байтов
+// и таблицу разделов с контрольной суммой каждого. Заголовок и таблица проверяются всегда,
+// содержимое разделов - по запросу: проверка читает весь файл, а без неё страницы подгружаются по мере поиска
+class IndexFile {
+public:
+    struct Section {
+        const char* data = nullptr;
+        std::size_t size = 0;
+    };
+
+    static std::shared_ptr<const IndexFile> Open(const std::string& path, bool verify_checksums);
+
+    ~IndexFile();
+
+    IndexFile(const IndexFile&) = delete;
+    IndexFile& operator=(const IndexFile&) = delete;
+
+    bool HasSection(IndexSection id) const;
+    Section GetSection(IndexSection id) const;
+
+private:
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    void* mapping_ = nullptr;
+    std::vector<std::pair<IndexSection, Section>> sections_;
+
+    IndexFile() = default;
+
+    void map(const std::string& path);
+    void readHeader(bool verify_checksums);
+};
+
+// Собирает разделы файла индекса и записывает их вместе с заголовком. Файл попадает на место,
+// только когда записан на диск целиком
+class IndexFileWriter {
+public:
+    std::string& AddSection(IndexSection id);
+    void Write(const std::string& path) const;
+
+private:
+    std::vector<std::pair<IndexSection, std::string>> sections_;
+};
+
+uint64_t ComputeChecksum(const char* data, std::size_t size);
+
+// Запись значений и массивов в раздел. Каждая запись дополняется до 8 байт,
+// чтобы массивы можно было читать прямо из отображённой памяти
+class SectionWriter {
+public:
+    explicit SectionWriter(std::string& out) : out_(out) {
+    }
+
+    template <typename T>
+    void Write(const T& value) {
+        WriteArray(&value, 1);
+    }
+
+    template <typename T>
+    void WriteArray(const T* values, std::size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out_.append(reinterpret_cast<const char*>(values), sizeof(T) * count);
+        out_.resize((out_.size() + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT);
+    }
+
+    static constexpr std::size_t ALIGNMENT = 8;
+
+private:
+    std::string& out_;
+};
+
+// Чтение раздела без копирования: возвращает указатели в отображённую память.
+// Выход за границы раздела означает повреждённый файл
+class SectionReader {
+public:
+    explicit SectionReader(IndexFile::Section section) : section_(section) {
+    }
+
+    template <typename T>
+    const T& Read() {
+        return *ReadArray<T>(1);
+    }
+
+    template <typename T>
+    const T* ReadArray(std::size_t count) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (count > (section_.size - position_) / sizeof(T)) {
+            throw std::runtime_error("Bad index file: section is truncated");
+        }
+        const T* values = reinterpret_cast<const T*>(section_.data + position_);
+        const std::size_t size = (sizeof(T) * count + SectionWriter::ALIGNMENT - 1) / SectionWriter::ALIGNMENT * SectionWriter::ALIGNMENT;
+        position_ = std::min(section_.size, position_ + size);
+        return values;
+    }
+
+private:
+    IndexFile::Section section_;
+    std::size_t position_ = 0;
+};
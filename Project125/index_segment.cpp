@@ -0,0 +1,247 @@
+#include "index_segment.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "index_file.h"
+
+static_assert(std::is_trivially_copyable_v<PostingBlock> && sizeof(PostingBlock) == 24, "PostingBlock is stored in index files as is");
+
+IndexSegment::IndexSegment(int id) : id_(id) {
+}
+
+int IndexSegment::GetId() const {
+    return id_;
+}
+
+int IndexSegment::GetDocumentCount() const {
+    return static_cast<int>(document_ids_.size());
+}
+
+const std::vector<int>& IndexSegment::GetDocumentIds() const {
+    return document_ids_;
+}
+
+PostingListView IndexSegment::Find(TermId term) const {
+    if (mapped_terms_ != nullptr) {
+        if (term < 0 || static_cast<std::size_t>(term) >= mapped_term_count_) {
+            return PostingListView();
+        }
+        const MappedTerm& mapped = mapped_terms_[term];
+        return PostingListView(mapped_blocks_ + mapped.first_block, mapped.block_count, mapped_data_ + mapped.data_offset, mapped.data_size, mapped.size, mapped.max_weight);
+    }
+    const auto it = term_indexes_.find(term);
+    return it == term_indexes_.end() ? PostingListView() : postings_[it->second].GetView();
+}
+
+void IndexSegment::AddDocument(int document_id, const TermCounts& term_counts, int word_count) {
+    materialize();
+    const double inv_word_count = 1.0 / word_count;
+    for (const auto& [term, count] : term_counts) {
+        getPostings(term).Insert(document_id, count, count * inv_word_count);
+    }
+    document_ids_.push_back(document_id);
+}
+
+void IndexSegment::RemoveDocuments(const std::map<int, std::vector<TermId>>& documents) {
+    materialize();
+    std::map<TermId, std::vector<int>> removed_documents;
+    for (const auto& [document_id, terms] : documents) {
+        for (const TermId term : terms) {
+            removed_documents[term].push_back(document_id);
+        }
+    }
+    for (const auto& [term, document_ids] : removed_documents) {
+        const auto it = term_indexes_.find(term);
+        if (it != term_indexes_.end()) {
+            postings_[it->second].Erase(document_ids);
+        }
+    }
+    document_ids_.erase(std::remove_if(document_ids_.begin(), document_ids_.end(), [&documents](int document_id) {
+        return documents.count(document_id) > 0;
+    }), document_ids_.end());
+}
+
+void IndexSegment::Seal() {
+    std::sort(document_ids_.begin(), document_ids_.end());
+    document_ids_.shrink_to_fit();
+    terms_.shrink_to_fit();
+    postings_.shrink_to_fit();
+    for (PostingList& postings : postings_) {
+        postings.ShrinkToFit();
+    }
+}
+
+std::shared_ptr<const IndexSegment> IndexSegment::Merge(int id, const std::vector<MergeSource>& sources) {
+    auto merged = std::make_shared<IndexSegment>(id);
+    std::vector<TermId> terms;
+    for (const MergeSource& source : sources) {
+        const std::vector<TermId> source_terms = source.segment->getTerms();
+        terms.insert(terms.end(), source_terms.begin(), source_terms.end());
+        for (const auto& [document_id, _] : source.live_documents) {
+            merged->document_ids_.push_back(document_id);
+        }
+    }
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    // Вес вхождения считается так же, как при добавлении документа, чтобы оценки блоков не изменились
+    struct WeightedPosting {
+        Posting posting;
+        double weight;
+    };
+    std::vector<WeightedPosting> postings;
+    for (const TermId term : terms) {
+        postings.clear();
+        for (const MergeSource& source : sources) {
+            const PostingListView list = source.segment->Find(term);
+            auto live = source.live_documents.begin();
+            for (const Posting posting : list) {
+                live = std::lower_bound(live, source.live_documents.end(), posting.document_id, [](const std::pair<int, int>& document, int document_id) {
+                    return document.first < document_id;
+                });
+                if (live == source.live_documents.end()) {
+                    break;
+                }
+                if (live->first == posting.document_id) {
+                    postings.push_back({ posting, posting.count * (1.0 / live->second) });
+                }
+            }
+        }
+        if (postings.empty()) {
+            continue;
+        }
+        std::sort(postings.begin(), postings.end(), [](const WeightedPosting& lhs, const WeightedPosting& rhs) {
+            return lhs.posting.document_id < rhs.posting.document_id;
+        });
+        PostingList& list = merged->getPostings(term);
+        for (const WeightedPosting& weighted : postings) {
+            list.Insert(weighted.posting.document_id, weighted.posting.count, weighted.weight);
+        }
+    }
+    merged->Seal();
+    return merged;
+}
+
+std::size_t IndexSegment::GetMemoryUsage() const {
+    std::size_t usage = sizeof(IndexSegment) + terms_.capacity() * sizeof(TermId) + document_ids_.capacity() * sizeof(int)
+        + term_indexes_.size() * (sizeof(TermId) + sizeof(int) + sizeof(void*)) + term_indexes_.bucket_count() * sizeof(void*);
+    for (const PostingList& postings : postings_) {
+        usage += postings.GetMemoryUsage();
+    }
+    return usage;
+}
+
+void IndexSegment::Save(SectionWriter& out, int term_count) const {
+    std::vector<MappedTerm> terms(term_count, MappedTerm{ 0, 0, 0, 0, 0, 0.0 });
+    std::vector<PostingBlock> blocks;
+    std::vector<uint8_t> data;
+    for (TermId term = 0; term < term_count; ++term) {
+        const PostingListView postings = Find(term);
+        terms[term] = { blocks.size(), postings.GetBlockCount(), data.size(), postings.GetDataSize(), postings.size(), postings.GetMaxWeight() };
+        blocks.insert(blocks.end(), postings.GetBlocks(), postings.GetBlocks() + postings.GetBlockCount());
+        data.insert(data.end(), postings.GetData(), postings.GetData() + postings.GetDataSize());
+    }
+    std::vector<int> document_ids = document_ids_;
+    std::sort(document_ids.begin(), document_ids.end());
+    out.Write<uint64_t>(terms.size());
+    out.Write<uint64_t>(document_ids.size());
+    out.Write<uint64_t>(blocks.size());
+    out.Write<uint64_t>(data.size());
+    out.WriteArray(terms.data(), terms.size());
+    out.WriteArray(document_ids.data(), document_ids.size());
+    out.WriteArray(blocks.data(), blocks.size());
+    out.WriteArray(data.data(), data.size());
+}
+
+std::shared_ptr<const IndexSegment> IndexSegment::Map(int id, SectionReader& in, std::shared_ptr<const void> storage) {
+    const uint64_t term_count = in.Read<uint64_t>();
+    const uint64_t document_count = in.Read<uint64_t>();
+    const uint64_t block_count = in.Read<uint64_t>();
+    const uint64_t data_size = in.Read<uint64_t>();
+    auto segment = std::make_shared<IndexSegment>(id);
+    segment->mapped_terms_ = in.ReadArray<MappedTerm>(term_count);
+    const int* document_ids = in.ReadArray<int>(document_count);
+    segment->mapped_blocks_ = in.ReadArray<PostingBlock>(block_count);
+    segment->mapped_data_ = in.ReadArray<uint8_t>(data_size);
+    // Списки слов лежат подряд, поэтому проверка заголовков всех блоков линейна по их числу и идёт
+    // при каждой загрузке: курсоры не выходят за раздел и без проверки контрольных сумм
+    uint64_t next_block = 0;
+    uint64_t next_data_offset = 0;
+    for (uint64_t term = 0; term < term_count; ++term) {
+        const MappedTerm& mapped = segment->mapped_terms_[term];
+        if (mapped.first_block != next_block || mapped.block_count > block_count - next_block
+            || mapped.data_offset != next_data_offset || mapped.data_size > data_size - next_data_offset) {
+            throw std::runtime_error("Bad index file: posting list is out of bounds");
+        }
+        checkMappedBlocks(segment->mapped_blocks_ + mapped.first_block, mapped);
+        next_block += mapped.block_count;
+        next_data_offset += mapped.data_size;
+    }
+    if (next_block != block_count || next_data_offset != data_size) {
+        throw std::runtime_error("Bad index file: posting list is out of bounds");
+    }
+    segment->mapped_term_count_ = term_count;
+    segment->document_ids_.assign(document_ids, document_ids + document_count);
+    segment->storage_ = std::move(storage);
+    return segment;
+}
+
+// Блоки слова идут по возрастанию id и смещений, и каждому хватает байт на свои varint:
+// счётчик первого вхождения и по два числа на остальные
+void IndexSegment::checkMappedBlocks(const PostingBlock* blocks, const MappedTerm& term) {
+    uint64_t size = 0;
+    for (uint64_t block = 0; block < term.block_count; ++block) {
+        const PostingBlock& current = blocks[block];
+        const bool is_last = block + 1 == term.block_count;
+        const uint64_t end = is_last ? term.data_size : blocks[block + 1].offset;
+        if (current.size == 0 || end > term.data_size || current.offset >= end || 2ull * current.size - 1 > end - current.offset
+            || current.first_document_id > current.last_document_id
+            || (!is_last && current.last_document_id >= blocks[block + 1].first_document_id)) {
+            throw std::runtime_error("Bad index file: bad posting block");
+        }
+        size += current.size;
+    }
+    if (size != term.size) {
+        throw std::runtime_error("Bad index file: bad posting block");
+    }
+}
+
+PostingList& IndexSegment::getPostings(TermId term) {
+    const auto [it, inserted] = term_indexes_.emplace(term, static_cast<int>(postings_.size()));
+    if (inserted) {
+        terms_.push_back(term);
+        postings_.emplace_back();
+    }
+    return postings_[it->second];
+}
+
+std::vector<TermId> IndexSegment::getTerms() const {
+    if (mapped_terms_ == nullptr) {
+        return terms_;
+    }
+    std::vector<TermId> terms;
+    for (std::size_t term = 0; term < mapped_term_count_; ++term) {
+        if (mapped_terms_[term].size > 0) {
+            terms.push_back(static_cast<TermId>(term));
+        }
+    }
+    return terms;
+}
+
+void IndexSegment::materialize() {
+    if (mapped_terms_ == nullptr) {
+        return;
+    }
+    for (const TermId term : getTerms()) {
+        term_indexes_.emplace(term, static_cast<int>(postings_.size()));
+        terms_.push_back(term);
+        postings_.emplace_back(Find(term));
+    }
+    mapped_terms_ = nullptr;
+    mapped_blocks_ = nullptr;
+    mapped_data_ = nullptr;
+    mapped_term_count_ = 0;
+    storage_.reset();
+}
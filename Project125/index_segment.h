@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "posting_list.h"
+#include "term_dictionary.h"
+
+class SectionReader;
+class SectionWriter;
+
+// Число вхождений слов документа по возрастанию номера слова
+using TermCounts = std::vector<std::pair<TermId, int>>;
+
+// Сегмент индекса: списки вхождений слов для части документов. В сегмент записи документы добавляются
+// по одному, запечатанный сегмент публикуется как const и больше не меняется: удалённые документы
+// убираются, когда он переписывается из живых документов или сливается с другими. Сегмент из файла индекса
+// читает списки вхождений прямо из отображённой памяти и копирует их, только если его нужно изменить
+class IndexSegment {
+public:
+    // Источник слияния: сегмент и его живые документы, пары id и числа слов по возрастанию id
+    struct MergeSource {
+        std::shared_ptr<const IndexSegment> segment;
+        std::vector<std::pair<int, int>> live_documents;
+    };
+
+    explicit IndexSegment(int id);
+
+    int GetId() const;
+    int GetDocumentCount() const;
+    const std::vector<int>& GetDocumentIds() const;
+
+    // Пустой список, если слова в сегменте нет
+    PostingListView Find(TermId term) const;
+
+    void AddDocument(int document_id, const TermCounts& term_counts, int word_count);
+    void RemoveDocuments(const std::map<int, std::vector<TermId>>& documents);
+
+    // Сортирует id документов и освобождает запас памяти списков вхождений
+    void Seal();
+
+    static std::shared_ptr<const IndexSegment> Merge(int id, const std::vector<MergeSource>& sources);
+
+    std::size_t GetMemoryUsage() const;
+
+    void Save(SectionWriter& out, int term_count) const;
+    // storage держит память раздела, пока жив сегмент
+    static std::shared_ptr<const IndexSegment> Map(int id, SectionReader& in, std::shared_ptr<const void> storage);
+
+private:
+    struct MappedTerm {
+        uint64_t first_block;
+        uint64_t block_count;
+        uint64_t data_offset;
+        uint64_t data_size;
+        uint64_t size;
+        double max_weight;
+    };
+
+    int id_;
+    std::vector<TermId> terms_;
+    std::vector<PostingList> postings_;
+    std::unordered_map<TermId, int> term_indexes_;
+    std::vector<int> document_ids_;
+
+    std::shared_ptr<const void> storage_;
+    std::size_t mapped_term_count_ = 0;
+    const MappedTerm* mapped_terms_ = nullptr;
+    const PostingBlock* mapped_blocks_ = nullptr;
+    const uint8_t* mapped_data_ = nullptr;
+
+    PostingList& getPostings(TermId term);
+    std::vector<TermId> getTerms() const;
+    static void checkMappedBlocks(const PostingBlock* blocks, const MappedTerm& term);
+    // Копирует списки вхождений из отображённой памяти, чтобы сегмент можно было менять
+    void materialize();
+};
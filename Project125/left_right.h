@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <type_traits>
+
+// Две копии объекта по схеме Left-Right: читатели без блокировок работают с активной копией,
+// писатель меняет неактивную, делает её активной, дожидается ухода читателей со старой
+// и повторяет на ней то же изменение. Изменения должны быть детерминированы, чтобы копии совпадали,
+// и не должны выполняться одновременно из нескольких потоков
+template <typename T>
+class LeftRight {
+public:
+    LeftRight() = default;
+
+    LeftRight(const LeftRight&) = delete;
+    LeftRight& operator=(const LeftRight&) = delete;
+
+    template <typename Function>
+    decltype(auto) Read(Function function) const {
+        ReadGuard guard(*this);
+        return function(static_cast<const T&>(instances_[guard.GetInstance()]));
+    }
+
+    // Если изменение бросило исключение на первой копии, ничего не публикуется
+    template <typename Function>
+    decltype(auto) Modify(Function function) {
+        const int active = active_.load();
+        T& inactive = instances_[1 - active];
+        if constexpr (std::is_void_v<std::invoke_result_t<Function&, T&>>) {
+            function(inactive);
+            publish(active);
+            function(instances_[active]);
+        }
+        else {
+            auto result = function(inactive);
+            publish(active);
+            function(instances_[active]);
+            return result;
+        }
+    }
+
+private:
+    static constexpr std::size_t READER_SHARD_COUNT = 16;
+
+    struct alignas(64) ReaderCounter {
+        std::atomic<int> count{ 0 };
+    };
+
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const LeftRight& left_right) : left_right_(left_right), shard_(getShard()) {
+            // После увеличения счётчика копия проверяется снова: если писатель успел её сменить,
+            // он мог не увидеть этого читателя, поэтому читатель уходит на новую копию
+            while (true) {
+                instance_ = left_right_.active_.load();
+                left_right_.readers_[instance_][shard_].count.fetch_add(1);
+                if (left_right_.active_.load() == instance_) {
+                    break;
+                }
+                left_right_.readers_[instance_][shard_].count.fetch_sub(1);
+            }
+        }
+
+        ~ReadGuard() {
+            left_right_.readers_[instance_][shard_].count.fetch_sub(1);
+        }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        int GetInstance() const {
+            return instance_;
+        }
+
+    private:
+        const LeftRight& left_right_;
+        std::size_t shard_;
+        int instance_ = 0;
+
+        static std::size_t getShard() {
+            thread_local const std::size_t shard = std::hash<std::thread::id>()(std::this_thread::get_id()) % READER_SHARD_COUNT;
+            return shard;
+        }
+    };
+
+    std::array<T, 2> instances_;
+    std::atomic<int> active_{ 0 };
+    mutable std::array<std::array<ReaderCounter, READER_SHARD_COUNT>, 2> readers_;
+
+    void publish(int old_active) {
+        active_.store(1 - old_active);
+        for (const ReaderCounter& counter : readers_[old_active]) {
+            while (counter.count.load() != 0) {
+                std::this_thread::yield();
+            }
+        }
+    }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// Кэш по строковому ключу с вытеснением самой давно использованной записи.
+// Поиск не выделяет память. Кэш не синхронизирован: им пользуется один поток
+template <typename Value>
+class LruCache {
+public:
+    explicit LruCache(std::size_t capacity) : capacity_(capacity) {
+    }
+
+    LruCache(const LruCache&) = delete;
+    LruCache& operator=(const LruCache&) = delete;
+
+    bool Find(std::string_view key, Value& value) {
+        const auto it = index_.find(key);
+        if (it == index_.end()) {
+            return false;
+        }
+        entries_.splice(entries_.begin(), entries_, it->second);
+        value = it->second->second;
+        return true;
+    }
+
+    void Insert(std::string_view key, const Value& value) {
+        if (capacity_ == 0) {
+            return;
+        }
+        const auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->second = value;
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return;
+        }
+        if (entries_.size() == capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.emplace_front(std::string(key), value);
+        index_.emplace(entries_.front().first, entries_.begin());
+    }
+
+    void Clear() {
+        index_.clear();
+        entries_.clear();
+    }
+
+    std::size_t size() const {
+        return entries_.size();
+    }
+
+private:
+    using Entry = std::pair<std::string, Value>;
+
+    std::size_t capacity_;
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, typename std::list<Entry>::iterator> index_;
+};
\ No newline at end of file
@@ -9,79 +9,95 @@ using namespace std;
 #include "tests.h"
 #include "log_duration.h"
 #include "remove_duplicates.h"
+#include "benchmarks.h"
 
-int main() {
+int main(int argc, char* argv[]) {
 
     TestSearchServer();
 
     {
-        SearchServer search_server("  "s);
+        SearchServer search_server("и в на"s);
 
-        AddDocument(search_server, 1, "   "s, DocumentStatus::ACTUAL, { 7, 2, 7 });
-        AddDocument(search_server, 1, "    "s, DocumentStatus::ACTUAL, { 1, 2 });
-        AddDocument(search_server, -1, "    "s, DocumentStatus::ACTUAL, { 1, 2 });
-        AddDocument(search_server, 3, "  \x12 "s, DocumentStatus::ACTUAL, { 1, 3, 2 });
-        AddDocument(search_server, 4, "   "s, DocumentStatus::ACTUAL, { 1, 1, 1 });
+        AddDocument(search_server, 1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, { 7, 2, 7 });
+        AddDocument(search_server, 1, "пушистый пёс и модный ошейник"s, DocumentStatus::ACTUAL, { 1, 2 });
+        AddDocument(search_server, -1, "пушистый пёс и модный ошейник"s, DocumentStatus::ACTUAL, { 1, 2 });
+        AddDocument(search_server, 3, "большой пёс скво\x12рец евгений"s, DocumentStatus::ACTUAL, { 1, 3, 2 });
+        AddDocument(search_server, 4, "большой пёс скворец евгений"s, DocumentStatus::ACTUAL, { 1, 1, 1 });
 
         {
             LOG_DURATION_STREAM("Operation time", cout);
-            FindTopDocuments(search_server, " -"s);
+            FindTopDocuments(search_server, "пушистый -пёс"s);
         }
-        FindTopDocuments(search_server, " --"s);
-        FindTopDocuments(search_server, " -"s);
+        FindTopDocuments(search_server, "пушистый --кот"s);
+        FindTopDocuments(search_server, "пушистый -"s);
 
-        MatchDocuments(search_server, " "s);
-        MatchDocuments(search_server, " -"s);
-        MatchDocuments(search_server, " --"s);
-        MatchDocuments(search_server, " - "s);
+        MatchDocuments(search_server, "пушистый пёс"s);
+        MatchDocuments(search_server, "модный -кот"s);
+        MatchDocuments(search_server, "модный --пёс"s);
+        MatchDocuments(search_server, "пушистый - хвост"s);
     }
 
     {
         SearchServer search_server;
-        search_server.SetStopWords("  "s);
+        search_server.SetStopWords("и в на"s);
 
-        search_server.AddDocument(0, "    "s, DocumentStatus::ACTUAL, { 8, -3 });
-        search_server.AddDocument(1, "   "s, DocumentStatus::ACTUAL, { 7, 2, 7 });
-        search_server.AddDocument(2, "   "s, DocumentStatus::ACTUAL, { 5, -12, 2, 1 });
-        search_server.AddDocument(3, "  "s, DocumentStatus::BANNED, { 9 });
+        search_server.AddDocument(0, "белый кот и модный ошейник"s, DocumentStatus::ACTUAL, { 8, -3 });
+        search_server.AddDocument(1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, { 7, 2, 7 });
+        search_server.AddDocument(2, "ухоженный пёс выразительные глаза"s, DocumentStatus::ACTUAL, { 5, -12, 2, 1 });
+        search_server.AddDocument(3, "ухоженный скворец евгений"s, DocumentStatus::BANNED, { 9 });
 
         cout << "ACTUAL by default:"s << endl;
-        for (const Document& document : search_server.FindTopDocuments("  "s)) {
+        for (const Document& document : search_server.FindTopDocuments("пушистый ухоженный кот"s)) {
             PrintDocument(document);
         }
 
         cout << "BANNED:"s << endl;
-        for (const Document& document : search_server.FindTopDocuments("  "s, DocumentStatus::BANNED)) {
+        for (const Document& document : search_server.FindTopDocuments("пушистый ухоженный кот"s, DocumentStatus::BANNED)) {
             PrintDocument(document);
         }
 
         cout << "Even ids:"s << endl;
-        for (const Document& document : search_server.FindTopDocuments("  "s, [](int document_id, DocumentStatus status, int rating) { return document_id % 2 == 0; })) {
+        for (const Document& document : search_server.FindTopDocuments("пушистый ухоженный кот"s, [](int document_id, DocumentStatus status, int rating) { return document_id % 2 == 0; })) {
             PrintDocument(document);
         }
     }
 
     {
-        SearchServer search_server("  "s);
+        SearchServer search_server("и в на"s);
         RequestQueue request_queue(search_server);
 
-        search_server.AddDocument(1, "   "s, DocumentStatus::ACTUAL, { 7, 2, 7 });
-        search_server.AddDocument(2, "    "s, DocumentStatus::ACTUAL, { 1, 2, 3 });
-        search_server.AddDocument(3, "    "s, DocumentStatus::ACTUAL, { 1, 2, 8 });
-        search_server.AddDocument(4, "   "s, DocumentStatus::ACTUAL, { 1, 3, 2 });
-        search_server.AddDocument(5, "   "s, DocumentStatus::ACTUAL, { 1, 1, 1 });
+        search_server.AddDocument(1, "пушистый кот пушистый хвост"s, DocumentStatus::ACTUAL, { 7, 2, 7 });
+        search_server.AddDocument(2, "пушистый пёс и модный ошейник"s, DocumentStatus::ACTUAL, { 1, 2, 3 });
+        search_server.AddDocument(3, "большой кот модный ошейник "s, DocumentStatus::ACTUAL, { 1, 2, 8 });
+        search_server.AddDocument(4, "большой пёс скворец евгений"s, DocumentStatus::ACTUAL, { 1, 3, 2 });
+        search_server.AddDocument(5, "большой пёс скворец василий"s, DocumentStatus::ACTUAL, { 1, 1, 1 });
 
-        // 1439    
+        // 1439 запросов с нулевым результатом
         for (int i = 0; i < 1439; ++i) {
-            request_queue.AddFindRequest(" "s);
+            request_queue.AddFindRequest("пустой запрос"s);
         }
-        //   1439    
-        request_queue.AddFindRequest(" "s);
-        //  ,   , 1438    
-        request_queue.AddFindRequest(" "s);
-        //   , 1437    
-        request_queue.AddFindRequest(""s);
-        cout << ",      "s << request_queue.GetNoResultRequests();
+        // все еще 1439 запросов с нулевым результатом
+        request_queue.AddFindRequest("пушистый пёс"s);
+        // новые сутки, первый запрос удален, 1438 запросов с нулевым результатом
+        request_queue.AddFindRequest("большой ошейник"s);
+        // первый запрос удален, 1437 запросов с нулевым результатом
+        request_queue.AddFindRequest("скворец"s);
+        cout << "Запросов, по которым ничего не нашлось "s << request_queue.GetNoResultRequests();
+    }
+
+    // Замеры производительности идут долго, поэтому запускаются только с ключом --benchmark
+    if (argc > 1 && argv[1] == "--benchmark"s) {
+        BenchmarkFindTopDocuments(cout);
+        BenchmarkProcessQueries(cout);
+        BenchmarkShardedSearchServer(cout);
+        BenchmarkIndexFile(cout);
+        BenchmarkWriteAheadLog(cout);
+        BenchmarkAddDocuments(cout);
+        BenchmarkIngestCorpus(cout);
+        BenchmarkSplitIntoWords(cout);
+        BenchmarkTermDictionary(cout);
+        BenchmarkRemoveDuplicates(cout);
+        BenchmarkNearDuplicates(cout);
     }
 
     {
@@ -90,25 +106,25 @@ int main() {
         AddDocument(search_server, 1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, { 7, 2, 7 });
         AddDocument(search_server, 2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, { 1, 2 });
 
-        //   2,  
+        // дубликат документа 2, будет удалён
         AddDocument(search_server, 3, "funny pet with curly hair"s, DocumentStatus::ACTUAL, { 1, 2 });
 
-        //    -,  
+        // отличие только в стоп-словах, считаем дубликатом
         AddDocument(search_server, 4, "funny pet and curly hair"s, DocumentStatus::ACTUAL, { 1, 2 });
 
-        //    ,    1
+        // множество слов такое же, считаем дубликатом документа 1
         AddDocument(search_server, 5, "funny funny pet and nasty nasty rat"s, DocumentStatus::ACTUAL, { 1, 2 });
 
-        //   ,   
+        // добавились новые слова, дубликатом не является
         AddDocument(search_server, 6, "funny pet and not very nasty rat"s, DocumentStatus::ACTUAL, { 1, 2 });
 
-        //    ,   id 6,    ,  
+        // множество слов такое же, как в id 6, несмотря на другой порядок, считаем дубликатом
         AddDocument(search_server, 7, "very nasty rat and not very funny pet"s, DocumentStatus::ACTUAL, { 1, 2 });
 
-        //    ,   
+        // есть не все слова, не является дубликатом
         AddDocument(search_server, 8, "pet with rat and rat and rat"s, DocumentStatus::ACTUAL, { 1, 2 });
 
-        //    ,   
+        // слова из разных документов, не является дубликатом
         AddDocument(search_server, 9, "nasty rat with curly hair"s, DocumentStatus::ACTUAL, { 1, 2 });
 
         cout << "Before duplicates removed: "s << search_server.GetDocumentCount() << endl;
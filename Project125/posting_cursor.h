@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+#include "posting_list.h"
+
+// Курсор по списку вхождений для поиска документ за документом. Кроме итератора хранит
+// указатель на блок, по заголовку которого оценивается вклад слова без декодирования вхождений
+class PostingCursor {
+public:
+    static constexpr int END_DOCUMENT_ID = std::numeric_limits<int>::max();
+
+    // Вклад вхождения равен его весу, умноженному на score_scale
+    PostingCursor(const PostingListView& postings, double score_scale)
+        : postings_(postings), it_(postings.begin()), end_(postings.end()), score_scale_(score_scale) {
+        update();
+    }
+
+    int GetDocumentId() const {
+        return document_id_;
+    }
+
+    int GetCount() const {
+        return it_->count;
+    }
+
+    double GetScoreScale() const {
+        return score_scale_;
+    }
+
+    double GetMaxScore() const {
+        return postings_.GetMaxWeight() * score_scale_;
+    }
+
+    void Next() {
+        ++it_;
+        update();
+    }
+
+    void SkipTo(long long document_id) {
+        if (document_id > END_DOCUMENT_ID) {
+            it_ = end_;
+        }
+        else {
+            it_.SkipTo(static_cast<int>(document_id));
+        }
+        update();
+    }
+
+    // Переводит указатель блока на блок, который может содержать document_id. Возвращает false, если таких блоков нет
+    bool ShallowSkipTo(int document_id) {
+        while (block_ < postings_.GetBlockCount() && postings_.GetBlock(block_).last_document_id < document_id) {
+            ++block_;
+        }
+        return block_ < postings_.GetBlockCount();
+    }
+
+    double GetBlockMaxScore() const {
+        return postings_.GetBlock(block_).max_weight * score_scale_;
+    }
+
+    int GetBlockFirstDocumentId() const {
+        return postings_.GetBlock(block_).first_document_id;
+    }
+
+    int GetBlockLastDocumentId() const {
+        return postings_.GetBlock(block_).last_document_id;
+    }
+
+private:
+    PostingListView postings_;
+    PostingListView::const_iterator it_;
+    PostingListView::const_iterator end_;
+    std::size_t block_ = 0;
+    int document_id_ = END_DOCUMENT_ID;
+    double score_scale_;
+
+    void update() {
+        document_id_ = it_ == end_ ? END_DOCUMENT_ID : it_->document_id;
+    }
+};
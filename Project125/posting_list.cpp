@@ -0,0 +1,226 @@
+#include "posting_list.h"
+
+#include <algorithm>
+
+int PostingListView::Find(int document_id) const {
+    const std::size_t block = FindBlock(document_id);
+    if (block == block_count_ || blocks_[block].first_document_id > document_id) {
+        return 0;
+    }
+    const uint8_t* pos = data_ + blocks_[block].offset;
+    int current_id = blocks_[block].first_document_id;
+    int count = static_cast<int>(DecodeVarint(pos));
+    for (uint32_t i = 1; i < blocks_[block].size && current_id < document_id; ++i) {
+        current_id += static_cast<int>(DecodeVarint(pos));
+        count = static_cast<int>(DecodeVarint(pos));
+    }
+    return current_id == document_id ? count : 0;
+}
+
+bool PostingListView::Contains(int document_id) const {
+    return Find(document_id) > 0;
+}
+
+std::size_t PostingListView::FindBlock(const Block* blocks, std::size_t block_count, int document_id) {
+    const Block* it = std::lower_bound(blocks, blocks + block_count, document_id, [](const Block& block, int id) {
+        return block.last_document_id < id;
+    });
+    return it - blocks;
+}
+
+PostingList::PostingList(const PostingListView& view)
+    : blocks_(view.GetBlocks(), view.GetBlocks() + view.GetBlockCount())
+    , data_(view.GetData(), view.GetData() + view.GetDataSize())
+    , size_(view.size())
+    , max_weight_(view.GetMaxWeight()) {
+}
+
+PostingList::const_iterator PostingList::begin() const {
+    return GetView().begin();
+}
+
+PostingList::const_iterator PostingList::end() const {
+    return GetView().end();
+}
+
+std::size_t PostingList::GetBlockCount() const {
+    return blocks_.size();
+}
+
+PostingList::const_iterator PostingList::BlockBegin(std::size_t block) const {
+    return GetView().BlockBegin(block);
+}
+
+std::size_t PostingList::size() const {
+    return size_;
+}
+
+bool PostingList::empty() const {
+    return size_ == 0;
+}
+
+void PostingList::Insert(int document_id, int count, double weight) {
+    max_weight_ = std::max(max_weight_, weight);
+    if (blocks_.empty() || document_id > blocks_.back().last_document_id) {
+        if (blocks_.empty() || blocks_.back().size == BLOCK_SIZE) {
+            blocks_.push_back({ document_id, document_id, static_cast<uint32_t>(data_.size()), 1, weight });
+        }
+        else {
+            Block& block = blocks_.back();
+            encodeVarint(data_, static_cast<uint32_t>(document_id - block.last_document_id));
+            block.last_document_id = document_id;
+            ++block.size;
+            block.max_weight = std::max(block.max_weight, weight);
+        }
+        encodeVarint(data_, static_cast<uint32_t>(count));
+        ++size_;
+        return;
+    }
+
+    const std::size_t block = FindBlock(document_id);
+    std::vector<Posting> postings = decodeBlock(block);
+    auto it = std::lower_bound(postings.begin(), postings.end(), document_id, [](const Posting& posting, int id) {
+        return posting.document_id < id;
+    });
+    if (it != postings.end() && it->document_id == document_id) {
+        it->count = count;
+    }
+    else {
+        postings.insert(it, { document_id, count });
+        ++size_;
+    }
+    replaceBlock(block, postings, block < blocks_.size() ? std::max(blocks_[block].max_weight, weight) : weight);
+}
+
+bool PostingList::Erase(int document_id) {
+    const std::size_t block = FindBlock(document_id);
+    if (block == blocks_.size() || blocks_[block].first_document_id > document_id) {
+        return false;
+    }
+    std::vector<Posting> postings = decodeBlock(block);
+    auto it = std::lower_bound(postings.begin(), postings.end(), document_id, [](const Posting& posting, int id) {
+        return posting.document_id < id;
+    });
+    if (it == postings.end() || it->document_id != document_id) {
+        return false;
+    }
+    postings.erase(it);
+    if (--size_ == 0) {
+        max_weight_ = 0.0;
+    }
+    replaceBlock(block, postings, blocks_[block].max_weight);
+    return true;
+}
+
+std::size_t PostingList::Erase(const std::vector<int>& sorted_document_ids) {
+    std::size_t erased = 0;
+    auto id = sorted_document_ids.begin();
+    for (std::size_t block = 0; block < blocks_.size() && id != sorted_document_ids.end();) {
+        id = std::lower_bound(id, sorted_document_ids.end(), blocks_[block].first_document_id);
+        if (id == sorted_document_ids.end() || *id > blocks_[block].last_document_id) {
+            ++block;
+            continue;
+        }
+        std::vector<Posting> postings = decodeBlock(block);
+        const auto kept_end = std::remove_if(postings.begin(), postings.end(), [&](const Posting& posting) {
+            return std::binary_search(id, sorted_document_ids.end(), posting.document_id);
+        });
+        erased += postings.end() - kept_end;
+        postings.erase(kept_end, postings.end());
+        const bool block_removed = postings.empty();
+        replaceBlock(block, postings, blocks_[block].max_weight);
+        if (!block_removed) {
+            ++block;
+        }
+    }
+    size_ -= erased;
+    if (size_ == 0) {
+        max_weight_ = 0.0;
+    }
+    return erased;
+}
+
+int PostingList::Find(int document_id) const {
+    return GetView().Find(document_id);
+}
+
+bool PostingList::Contains(int document_id) const {
+    return Find(document_id) > 0;
+}
+
+std::size_t PostingList::FindBlock(int document_id) const {
+    return PostingListView::FindBlock(blocks_.data(), blocks_.size(), document_id);
+}
+
+const PostingList::Block& PostingList::GetBlock(std::size_t block) const {
+    return blocks_[block];
+}
+
+double PostingList::GetMaxWeight() const {
+    return max_weight_;
+}
+
+std::size_t PostingList::GetMemoryUsage() const {
+    return sizeof(PostingList) + blocks_.capacity() * sizeof(Block) + data_.capacity();
+}
+
+void PostingList::ShrinkToFit() {
+    blocks_.shrink_to_fit();
+    data_.shrink_to_fit();
+}
+
+std::vector<Posting> PostingList::decodeBlock(std::size_t block) const {
+    std::vector<Posting> postings;
+    if (block == blocks_.size()) {
+        return postings;
+    }
+    postings.reserve(blocks_[block].size + 1);
+    const PostingListView view = GetView();
+    for (auto it = view.BlockBegin(block); it != view.BlockBegin(block + 1); ++it) {
+        postings.push_back(*it);
+    }
+    return postings;
+}
+
+void PostingList::replaceBlock(std::size_t block, const std::vector<Posting>& postings, double max_weight) {
+    const std::size_t old_begin = block < blocks_.size() ? blocks_[block].offset : data_.size();
+    const std::size_t old_end = block + 1 < blocks_.size() ? blocks_[block + 1].offset : data_.size();
+
+    // Переполненный блок делится пополам, чтобы следующие вставки в середину не плодили мелкие блоки.
+    // Веса вхождений не хранятся, поэтому части блока наследуют его оценку веса
+    const std::size_t block_size = postings.size() > BLOCK_SIZE ? (postings.size() + 1) / 2 : BLOCK_SIZE;
+    std::vector<uint8_t> bytes;
+    std::vector<Block> new_blocks;
+    for (auto first = postings.begin(); first != postings.end();) {
+        const auto last = static_cast<std::size_t>(postings.end() - first) > block_size ? first + block_size : postings.end();
+        new_blocks.push_back({ first->document_id, (last - 1)->document_id, static_cast<uint32_t>(old_begin + bytes.size()), static_cast<uint32_t>(last - first), max_weight });
+        encodeBlock(bytes, first, last);
+        first = last;
+    }
+
+    data_.erase(data_.begin() + old_begin, data_.begin() + old_end);
+    data_.insert(data_.begin() + old_begin, bytes.begin(), bytes.end());
+
+    const std::ptrdiff_t shift = static_cast<std::ptrdiff_t>(bytes.size()) - static_cast<std::ptrdiff_t>(old_end - old_begin);
+    auto next = blocks_.erase(blocks_.begin() + std::min(block, blocks_.size()), blocks_.begin() + std::min(block + 1, blocks_.size()));
+    next = blocks_.insert(next, new_blocks.begin(), new_blocks.end()) + new_blocks.size();
+    for (; next != blocks_.end(); ++next) {
+        next->offset = static_cast<uint32_t>(next->offset + shift);
+    }
+}
+
+void PostingList::encodeVarint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void PostingList::encodeBlock(std::vector<uint8_t>& out, std::vector<Posting>::const_iterator first, std::vector<Posting>::const_iterator last) {
+    encodeVarint(out, static_cast<uint32_t>(first->count));
+    for (auto prev = first++; first != last; prev = first++) {
+        encodeVarint(out, static_cast<uint32_t>(first->document_id - prev->document_id));
+        encodeVarint(out, static_cast<uint32_t>(first->count));
+    }
+}
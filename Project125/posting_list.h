@@ -0,0 +1,236 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+struct Posting {
+    int document_id = 0;
+    int count = 0;
+};
+
+// Заголовок блока вхождений: первый и последний id, смещение байтов блока от начала данных списка,
+// число вхождений и верхняя оценка их весов. Файл индекса хранит заголовки в этом же виде
+struct PostingBlock {
+    int first_document_id;
+    int last_document_id;
+    uint32_t offset;
+    uint32_t size;
+    double max_weight;
+};
+
+// Список вхождений только для чтения поверх чужой памяти: массивов PostingList или страниц
+// отображённого в память файла индекса. Копируется дёшево, действителен, пока жива память под ним
+class PostingListView {
+public:
+    using Block = PostingBlock;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Posting;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Posting*;
+        using reference = const Posting&;
+
+        const_iterator() = default;
+        const_iterator(const PostingListView& list, std::size_t block) : blocks_(list.blocks_), block_count_(list.block_count_), data_(list.data_), block_(block) {
+            loadBlock();
+        }
+
+        reference operator*() const {
+            return current_;
+        }
+
+        pointer operator->() const {
+            return &current_;
+        }
+
+        const_iterator& operator++() {
+            if (++index_ == blocks_[block_].size) {
+                ++block_;
+                loadBlock();
+            }
+            else {
+                current_.document_id += static_cast<int>(DecodeVarint(pos_));
+                current_.count = static_cast<int>(DecodeVarint(pos_));
+            }
+            return *this;
+        }
+
+        // Сдвигает итератор к первому вхождению с id не меньше заданного, блоки целиком пропускаются по заголовкам
+        const_iterator& SkipTo(int document_id) {
+            if (block_ < block_count_ && blocks_[block_].last_document_id < document_id) {
+                block_ = FindBlock(blocks_, block_count_, document_id);
+                loadBlock();
+            }
+            while (block_ < block_count_ && current_.document_id < document_id) {
+                ++*this;
+            }
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return block_ == other.block_ && index_ == other.index_;
+        }
+
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        const Block* blocks_ = nullptr;
+        std::size_t block_count_ = 0;
+        const uint8_t* data_ = nullptr;
+        std::size_t block_ = 0;
+        uint32_t index_ = 0;
+        const uint8_t* pos_ = nullptr;
+        Posting current_;
+
+        void loadBlock() {
+            index_ = 0;
+            if (block_ >= block_count_) {
+                return;
+            }
+            const Block& block = blocks_[block_];
+            pos_ = data_ + block.offset;
+            current_.document_id = block.first_document_id;
+            current_.count = static_cast<int>(DecodeVarint(pos_));
+        }
+    };
+
+    PostingListView() = default;
+    PostingListView(const Block* blocks, std::size_t block_count, const uint8_t* data, std::size_t data_size, std::size_t size, double max_weight)
+        : blocks_(blocks), block_count_(block_count), data_(data), data_size_(data_size), size_(size), max_weight_(max_weight) {
+    }
+
+    const_iterator begin() const {
+        return const_iterator(*this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(*this, block_count_);
+    }
+
+    std::size_t GetBlockCount() const {
+        return block_count_;
+    }
+
+    const_iterator BlockBegin(std::size_t block) const {
+        return const_iterator(*this, block);
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    int Find(int document_id) const;
+    bool Contains(int document_id) const;
+
+    std::size_t FindBlock(int document_id) const {
+        return FindBlock(blocks_, block_count_, document_id);
+    }
+
+    const Block& GetBlock(std::size_t block) const {
+        return blocks_[block];
+    }
+
+    double GetMaxWeight() const {
+        return max_weight_;
+    }
+
+    const Block* GetBlocks() const {
+        return blocks_;
+    }
+
+    const uint8_t* GetData() const {
+        return data_;
+    }
+
+    std::size_t GetDataSize() const {
+        return data_size_;
+    }
+
+    static std::size_t FindBlock(const Block* blocks, std::size_t block_count, int document_id);
+
+    static uint32_t DecodeVarint(const uint8_t*& pos) {
+        uint32_t value = *pos & 0x7F;
+        int shift = 7;
+        while (*pos++ & 0x80) {
+            value |= static_cast<uint32_t>(*pos & 0x7F) << shift;
+            shift += 7;
+        }
+        return value;
+    }
+
+private:
+    const Block* blocks_ = nullptr;
+    std::size_t block_count_ = 0;
+    const uint8_t* data_ = nullptr;
+    std::size_t data_size_ = 0;
+    std::size_t size_ = 0;
+    double max_weight_ = 0.0;
+};
+
+// Сжатый список вхождений слова: id документов отсортированы, хранятся разностями
+// в varint-кодировке и разбиты на блоки, чтобы вставка и удаление перекодировали только один блок.
+// Вместе с вхождением передаётся его вес, и заголовок блока хранит верхнюю оценку весов своих вхождений
+class PostingList {
+public:
+    static const uint32_t BLOCK_SIZE = 128;
+
+    using Block = PostingBlock;
+    using const_iterator = PostingListView::const_iterator;
+
+    PostingList() = default;
+    // Копирует блоки и байты списка без перекодирования
+    explicit PostingList(const PostingListView& view);
+
+    PostingListView GetView() const {
+        return PostingListView(blocks_.data(), blocks_.size(), data_.data(), data_.size(), size_, max_weight_);
+    }
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    std::size_t GetBlockCount() const;
+    const_iterator BlockBegin(std::size_t block) const;
+
+    std::size_t size() const;
+    bool empty() const;
+
+    void Insert(int document_id, int count, double weight = 0.0);
+    bool Erase(int document_id);
+    std::size_t Erase(const std::vector<int>& sorted_document_ids);
+
+    int Find(int document_id) const;
+    bool Contains(int document_id) const;
+
+    std::size_t FindBlock(int document_id) const;
+    const Block& GetBlock(std::size_t block) const;
+    double GetMaxWeight() const;
+
+    std::size_t GetMemoryUsage() const;
+    void ShrinkToFit();
+
+    static uint32_t DecodeVarint(const uint8_t*& pos) {
+        return PostingListView::DecodeVarint(pos);
+    }
+
+private:
+    std::vector<Block> blocks_;
+    std::vector<uint8_t> data_;
+    std::size_t size_ = 0;
+    double max_weight_ = 0.0;
+
+    std::vector<Posting> decodeBlock(std::size_t block) const;
+    void replaceBlock(std::size_t block, const std::vector<Posting>& postings, double max_weight);
+
+    static void encodeVarint(std::vector<uint8_t>& out, uint32_t value);
+    static void encodeBlock(std::vector<uint8_t>& out, std::vector<Posting>::const_iterator first, std::vector<Posting>::const_iterator last);
+};
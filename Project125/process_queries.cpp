@@ -0,0 +1,61 @@
+#include "process_queries.h"
+
+#include <algorithm>
+#include <exception>
+#include <execution>
+#include <numeric>
+
+std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries) {
+    std::vector<std::vector<Document>> results(queries.size());
+    std::vector<std::exception_ptr> errors(queries.size());
+    std::vector<std::size_t> indexes(queries.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::for_each(std::execution::par, indexes.begin(), indexes.end(), [&](std::size_t index) {
+        try {
+            results[index] = search_server.FindTopDocuments(queries[index]);
+        }
+        catch (...) {
+            errors[index] = std::current_exception();
+        }
+    });
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return results;
+}
+
+std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries) {
+    // У каждого запроса своё место в общем буфере на MAX_RESULT_DOCUMENT_COUNT документов. Поиск пишет
+    // результат прямо туда, а затем результаты сдвигаются к началу буфера, закрывая незанятые места
+    const std::size_t stride = MAX_RESULT_DOCUMENT_COUNT;
+    std::vector<Document> joined(queries.size() * stride);
+    std::vector<std::size_t> counts(queries.size());
+    std::vector<std::exception_ptr> errors(queries.size());
+    std::vector<std::size_t> indexes(queries.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::for_each(std::execution::par, indexes.begin(), indexes.end(), [&](std::size_t index) {
+        try {
+            counts[index] = search_server.FindTopDocuments(queries[index], DocumentStatus::ACTUAL, MAX_RESULT_DOCUMENT_COUNT, joined.data() + index * stride);
+        }
+        catch (...) {
+            errors[index] = std::current_exception();
+        }
+    });
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::size_t size = 0;
+    for (std::size_t index = 0; index < queries.size(); ++index) {
+        if (size != index * stride) {
+            std::move(joined.begin() + index * stride, joined.begin() + index * stride + counts[index], joined.begin() + size);
+        }
+        size += counts[index];
+    }
+    joined.resize(size);
+    return joined;
+}
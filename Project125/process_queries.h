@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "document.h"
+#include "search_server.h"
+
+// Обрабатывает пакет запросов параллельно, результаты возвращаются в порядке запросов
+std::vector<std::vector<Document>> ProcessQueries(const SearchServer& search_server, const std::vector<std::string>& queries);
+
+// То же, но результаты всех запросов склеены в один плоский вектор. Поиск пишет их сразу в общий буфер,
+// без отдельного вектора на каждый запрос
+std::vector<Document> ProcessQueriesJoined(const SearchServer& search_server, const std::vector<std::string>& queries);
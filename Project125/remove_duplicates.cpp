@@ -1,48 +1,221 @@
 #include "remove_duplicates.h"
 
 #include <algorithm>
-#include <set>
+#include <cstdint>
+#include <execution>
 #include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Хеш набора слов документа: id слов идут по возрастанию, поэтому порядок и частоты слов в тексте не важны
+uint64_t computeSignature(const TagData& words) {
+    uint64_t signature = words.size();
+    for (const auto& [term, _] : words) {
+        signature = (signature ^ static_cast<uint64_t>(term)) * 0x100000001B3ull;
+        signature ^= signature >> 29;
+    }
+    return signature;
+}
+
+bool haveSameWords(const TagData& lhs, const TagData& rhs) {
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const auto& lhs_word, const auto& rhs_word) {
+        return lhs_word.first == rhs_word.first;
+    });
+}
+
+}
 
 void RemoveDuplicates(SearchServer& search_server) {
+    // Документы перебираются по возрастанию id, поэтому первый документ с данным набором слов остаётся,
+    // а остальные удаляются. Документы с одинаковым хешем набора сравниваются по словам с оставленными
+    // документами этого хеша, так что совпадение хешей разных наборов не удаляет лишнего
+    std::unordered_map<uint64_t, std::vector<int>> originals;
+    std::vector<int> duplicates;
+    for (const int document_id : search_server) {
+        const TagData& words = search_server.GetWordFrequencies(document_id);
+        std::vector<int>& same_signature = originals[computeSignature(words)];
+        const bool is_duplicate = std::any_of(same_signature.begin(), same_signature.end(), [&](int original_id) {
+            return haveSameWords(search_server.GetWordFrequencies(original_id), words);
+        });
+        if (is_duplicate) {
+            duplicates.push_back(document_id);
+        }
+        else {
+            same_signature.push_back(document_id);
+        }
+    }
+    for (const int document_id : duplicates) {
+        std::cout << "Found duplicate document id " << document_id << std::endl;
+    }
+    search_server.RemoveDocuments(duplicates);
+}
 
-    const int document_count = search_server.GetDocumentCount();
-    std::set<int> dup;
-    for (int i = 0; i < document_count; ++i) {
-        for (int j = i + 1; j < document_count; ++j) {
-            int lhsid = search_server.GetDocumentId(i);
-            int rhsid = search_server.GetDocumentId(j);
-            const TagData& map1 = search_server.GetWordFrequencies(lhsid);
-            const TagData& map2 = search_server.GetWordFrequencies(rhsid);
+namespace {
 
-            std::size_t sz1 = map1.size();
-            std::size_t sz2 = map2.size();
+uint64_t mixBits(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xBF58476D1CE4E5B9ull;
+    value ^= value >> 27;
+    value *= 0x94D049BB133111EBull;
+    return value ^ (value >> 31);
+}
 
-            if (sz1 != sz2) {
-                continue;
-            }
+// Сигнатура MinHash: минимумы hash_count хешей по словам документа. Хеши строятся из одного 64-битного хеша слова
+// как h1 + i * h2 и перемешиваются 32-битным финализатором: без него соседние хеши зависимы, строки одной полосы
+// совпадают не независимо, и похожие документы чаще не совпадают ни в одной полосе
+void computeMinHash(const std::vector<TermId>& terms, uint32_t* signature, int hash_count) {
+    std::fill(signature, signature + hash_count, std::numeric_limits<uint32_t>::max());
+    for (const TermId term : terms) {
+        const uint64_t hash = mixBits(static_cast<uint64_t>(term));
+        const uint32_t first = static_cast<uint32_t>(hash);
+        const uint32_t second = static_cast<uint32_t>(hash >> 32) | 1;
+        for (int i = 0; i < hash_count; ++i) {
+            uint32_t value = first + static_cast<uint32_t>(i) * second;
+            value ^= value >> 16;
+            value *= 0x7FEB352Du;
+            value ^= value >> 15;
+            value *= 0x846CA68Bu;
+            value ^= value >> 16;
+            signature[i] = std::min(signature[i], value);
+        }
+    }
+}
 
-            TagData::const_iterator map1It = map1.begin();
-            TagData::const_iterator map2It = map2.begin();
+double computeJaccard(const std::vector<TermId>& lhs, const std::vector<TermId>& rhs) {
+    if (lhs.empty() && rhs.empty()) {
+        return 1.0;
+    }
+    std::size_t common = 0;
+    for (auto lhs_it = lhs.begin(), rhs_it = rhs.begin(); lhs_it != lhs.end() && rhs_it != rhs.end();) {
+        if (*lhs_it < *rhs_it) {
+            ++lhs_it;
+        }
+        else if (*rhs_it < *lhs_it) {
+            ++rhs_it;
+        }
+        else {
+            ++common;
+            ++lhs_it;
+            ++rhs_it;
+        }
+    }
+    return static_cast<double>(common) / static_cast<double>(lhs.size() + rhs.size() - common);
+}
 
-            std::size_t cnt = 0;
-            while (map2It != map2.end() && map1It != map1.end()) {
-                if (map1It->first != map2It->first) {
-                    break;
-                }
-                if (map1It->first == map2It->first) {
-                    ++cnt;
+}
+
+std::vector<std::vector<int>> FindNearDuplicates(const SearchServer& search_server, const NearDuplicateOptions& options) {
+    if (options.hash_count <= 0 || options.band_count <= 0 || options.hash_count % options.band_count != 0
+        || !(options.jaccard_threshold >= 0.0 && options.jaccard_threshold <= 1.0)) {
+        throw std::invalid_argument("Bad near-duplicate options");
+    }
+    const std::vector<int> document_ids(search_server.begin(), search_server.end());
+    const std::size_t document_count = document_ids.size();
+    const int hash_count = options.hash_count;
+    const int rows = options.hash_count / options.band_count;
+
+    std::vector<std::size_t> indexes(document_count);
+    std::iota(indexes.begin(), indexes.end(), 0);
+    std::vector<std::vector<TermId>> terms(document_count);
+    std::vector<uint32_t> signatures(document_count * hash_count);
+    std::for_each(std::execution::par, indexes.begin(), indexes.end(), [&](std::size_t index) {
+        for (const auto& [term, _] : search_server.GetWordFrequencies(document_ids[index])) {
+            terms[index].push_back(term);
+        }
+        computeMinHash(terms[index], signatures.data() + index * hash_count, hash_count);
+    });
+
+    // Документы с одинаковой полосой сигнатуры попадают в одну корзину. В корзине документ становится
+    // кандидатом в пару с первым и с предыдущим документом: число пар линейно даже для больших корзин
+    // одинаковых документов, а пары, пропущенные в одной полосе, обычно находятся в другой
+    std::vector<int> bands(options.band_count);
+    std::iota(bands.begin(), bands.end(), 0);
+    std::vector<std::vector<std::pair<int, int>>> band_candidates(options.band_count);
+    std::for_each(std::execution::par, bands.begin(), bands.end(), [&](int band) {
+        std::vector<std::pair<uint64_t, int>> buckets(document_count);
+        for (std::size_t index = 0; index < document_count; ++index) {
+            uint64_t key = band;
+            const uint32_t* rows_begin = signatures.data() + index * hash_count + band * rows;
+            for (int row = 0; row < rows; ++row) {
+                key = mixBits(key ^ rows_begin[row]);
+            }
+            buckets[index] = { key, static_cast<int>(index) };
+        }
+        std::sort(buckets.begin(), buckets.end());
+        std::vector<std::pair<int, int>>& candidates = band_candidates[band];
+        for (std::size_t begin = 0, end = 0; begin < document_count; begin = end) {
+            while (end < document_count && buckets[end].first == buckets[begin].first) {
+                ++end;
+            }
+            for (std::size_t i = begin + 1; i < end; ++i) {
+                candidates.emplace_back(buckets[begin].second, buckets[i].second);
+                if (i > begin + 1) {
+                    candidates.emplace_back(buckets[i - 1].second, buckets[i].second);
                 }
-                ++map1It;
-                ++map2It;
             }
-            if (cnt == sz1) {
-                dup.insert(rhsid);
+        }
+    });
+    std::vector<std::pair<int, int>> candidates;
+    for (const auto& band : band_candidates) {
+        candidates.insert(candidates.end(), band.begin(), band.end());
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<char> is_similar(candidates.size());
+    std::transform(std::execution::par, candidates.begin(), candidates.end(), is_similar.begin(), [&](const std::pair<int, int>& candidate) {
+        return computeJaccard(terms[candidate.first], terms[candidate.second]) >= options.jaccard_threshold;
+    });
+
+    // Связная компонента похожих пар может быть цепочкой A~B~C, где A и C уже не похожи. Поэтому группа
+    // строится вокруг представителя - документа с наименьшим id, ещё не вошедшего в группу: в неё входят
+    // только документы, проверенная пара которых с ним самим похожа. Каждая пара просматривается один раз,
+    // без повторных сравнений внутри компоненты
+    std::vector<std::vector<int>> similar(document_count);
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (is_similar[i]) {
+            similar[candidates[i].first].push_back(candidates[i].second);
+            similar[candidates[i].second].push_back(candidates[i].first);
+        }
+    }
+    std::vector<bool> is_grouped(document_count, false);
+    std::vector<std::vector<int>> groups;
+    for (std::size_t representative = 0; representative < document_count; ++representative) {
+        if (is_grouped[representative]) {
+            continue;
+        }
+        is_grouped[representative] = true;
+        std::vector<int> group = { document_ids[representative] };
+        for (const int index : similar[representative]) {
+            if (!is_grouped[index]) {
+                is_grouped[index] = true;
+                group.push_back(document_ids[index]);
             }
         }
+        if (group.size() > 1) {
+            std::sort(group.begin() + 1, group.end());
+            groups.push_back(std::move(group));
+        }
     }
-    for (int i : dup) {
-        std::cout << "Found duplicate document id " << i << std::endl;
-        search_server.RemoveDocument(i);
+    std::sort(groups.begin(), groups.end());
+    return groups;
+}
+
+void RemoveNearDuplicates(SearchServer& search_server, const NearDuplicateOptions& options) {
+    std::vector<int> duplicates;
+    for (const std::vector<int>& group : FindNearDuplicates(search_server, options)) {
+        std::cout << "Found near-duplicate documents";
+        for (const int document_id : group) {
+            std::cout << ' ' << document_id;
+        }
+        std::cout << std::endl;
+        duplicates.insert(duplicates.end(), group.begin() + 1, group.end());
     }
-}
\ No newline at end of file
+    std::sort(duplicates.begin(), duplicates.end());
+    search_server.RemoveDocuments(duplicates);
+}
@@ -1,7 +1,28 @@
 #pragma once
 
+#include <vector>
+
 #include "search_server.h"
 
-using TagData = std::map<std::string, double>;
+using TagData = std::map<TermId, double>;
+
+void RemoveDuplicates(SearchServer& search_server);
+
+struct NearDuplicateOptions {
+    // Документы почти одинаковы, если коэффициент Жаккара их наборов слов не меньше порога
+    double jaccard_threshold = 0.8;
+    // Длина сигнатуры MinHash и число полос LSH, на которые она делится. Документы становятся кандидатами,
+    // если совпала хотя бы одна полоса: больше полос - больше найденных пар с небольшим сходством и больше проверок
+    int hash_count = 128;
+    int band_count = 32;
+};
+
+// Группы почти одинаковых документов. Пары-кандидаты находятся по полосам сигнатур MinHash без перебора всех пар
+// и проверяются точным коэффициентом Жаккара. Первый документ группы - её представитель с наименьшим id, сходство
+// с ним каждого другого документа группы не ниже порога, и их пара нашлась среди кандидатов. Документы в группе
+// и группы упорядочены по возрастанию id.
+// Сервер не должен меняться во время поиска
+std::vector<std::vector<int>> FindNearDuplicates(const SearchServer& search_server, const NearDuplicateOptions& options = {});
 
-void RemoveDuplicates(SearchServer& search_server);
\ No newline at end of file
+// Выводит найденные группы почти одинаковых документов и оставляет в каждой только представителя
+void RemoveNearDuplicates(SearchServer& search_server, const NearDuplicateOptions& options = {});
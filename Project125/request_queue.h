@@ -1,28 +1,43 @@
 #pragma once
 
-#include <string>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <typeinfo>
 #include <vector>
 #include <deque>
 
 #include "search_server.h"
 #include "document.h"
+#include "result_cache.h"
 
 class RequestQueue {
 public:
-    explicit RequestQueue(const SearchServer& search_server);
+    // Кэш результатов можно передать общий для нескольких очередей к одному серверу
+    explicit RequestQueue(const SearchServer& search_server, std::shared_ptr<ResultCache> cache = std::make_shared<ResultCache>());
 
-    //  ""    ,      
+    // сделаем "обертки" для всех методов поиска, чтобы сохранять результаты для нашей статистики
     template <typename DocumentPredicate>
-    std::vector<Document> AddFindRequest(const std::string& raw_query, const DocumentPredicate& document_predicate) {
-        const auto result = search_server_.FindTopDocuments(raw_query, document_predicate);
-        AddRequest(result.size());
-        return result;
+    std::vector<Document> AddFindRequest(std::string_view raw_query, const DocumentPredicate& document_predicate) {
+        // Предикат без состояния определяется своим типом, результаты с захватом состояния не кэшируются
+        if constexpr (std::is_empty_v<DocumentPredicate>) {
+            return findCached(raw_query, typeid(DocumentPredicate).name(), [&] {
+                return search_server_.FindTopDocuments(raw_query, document_predicate);
+            });
+        }
+        else {
+            const auto result = search_server_.FindTopDocuments(raw_query, document_predicate);
+            AddRequest(result.size());
+            return result;
+        }
     }
 
-    std::vector<Document> AddFindRequest(const std::string& raw_query, DocumentStatus status);
-    std::vector<Document> AddFindRequest(const std::string& raw_query);
+    std::vector<Document> AddFindRequest(std::string_view raw_query, DocumentStatus status);
+    std::vector<Document> AddFindRequest(std::string_view raw_query);
 
     int GetNoResultRequests() const;
+    ResultCache::Stats GetCacheStats() const;
 
 private:
     struct QueryResult {
@@ -32,9 +47,23 @@ private:
 
     std::deque<QueryResult> requests_;
     const SearchServer& search_server_;
+    std::shared_ptr<ResultCache> cache_;
     int no_results_requests_;
     uint64_t current_time_;
     const static int sec_in_day_ = 1440;
 
     void AddRequest(int results_num);
+
+    template <typename Search>
+    std::vector<Document> findCached(std::string_view raw_query, std::string_view filter, Search search) {
+        const std::string key = ResultCache::MakeKey(raw_query, filter);
+        const uint64_t epoch = search_server_.GetEpoch();
+        std::optional<std::vector<Document>> result = cache_->Find(key, epoch);
+        if (!result) {
+            result = search();
+            cache_->Insert(key, epoch, *result);
+        }
+        AddRequest(result->size());
+        return std::move(*result);
+    }
 };
\ No newline at end of file
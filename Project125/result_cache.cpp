@@ -0,0 +1,77 @@
+#include "result_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "string_processing.h"
+
+ResultCache::ResultCache(std::size_t capacity) : capacity_(capacity), sketch_(capacity) {
+}
+
+std::optional<std::vector<Document>> ResultCache::Find(const std::string& key, uint64_t epoch) {
+    std::lock_guard guard(mutex_);
+    sketch_.Increment(std::hash<std::string>{}(key));
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return std::nullopt;
+    }
+    if (it->second->epoch != epoch) {
+        entries_.erase(it->second);
+        index_.erase(it);
+        ++stats_.misses;
+        return std::nullopt;
+    }
+    entries_.splice(entries_.begin(), entries_, it->second);
+    ++stats_.hits;
+    return it->second->documents;
+}
+
+void ResultCache::Insert(const std::string& key, uint64_t epoch, const std::vector<Document>& documents) {
+    if (capacity_ == 0) {
+        return;
+    }
+    std::lock_guard guard(mutex_);
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+        it->second->epoch = epoch;
+        it->second->documents = documents;
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return;
+    }
+    if (entries_.size() == capacity_) {
+        const Entry& victim = entries_.back();
+        // Запись с устаревшей эпохой уже не найдётся, её вытесняем без сравнения частот
+        if (victim.epoch == epoch && sketch_.Estimate(std::hash<std::string>{}(key)) <= sketch_.Estimate(std::hash<std::string>{}(victim.key))) {
+            ++stats_.rejections;
+            return;
+        }
+        index_.erase(victim.key);
+        entries_.pop_back();
+        ++stats_.evictions;
+    }
+    entries_.push_front({ key, epoch, documents });
+    index_.emplace(entries_.front().key, entries_.begin());
+}
+
+std::size_t ResultCache::size() const {
+    std::lock_guard guard(mutex_);
+    return entries_.size();
+}
+
+ResultCache::Stats ResultCache::GetStats() const {
+    std::lock_guard guard(mutex_);
+    return stats_;
+}
+
+std::string ResultCache::MakeKey(std::string_view raw_query, std::string_view filter) {
+    std::vector<std::string_view> words = SplitIntoWords(raw_query);
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    std::string key(filter);
+    for (const std::string_view word : words) {
+        key += ' ';
+        key += word;
+    }
+    return key;
+}
\ No newline at end of file
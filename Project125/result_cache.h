@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "document.h"
+#include "frequency_sketch.h"
+
+const std::size_t DEFAULT_RESULT_CACHE_CAPACITY = 1024;
+
+// Кэш результатов поиска. Вытесняется самая давно использованная запись, но новая запись принимается,
+// только если её запрашивали чаще, чем вытесняемую (TinyLFU). Каждая запись помнит эпоху индекса,
+// на которой получена, и после изменения индекса перестаёт находиться. Можно использовать из нескольких потоков
+class ResultCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t rejections = 0;
+    };
+
+    explicit ResultCache(std::size_t capacity = DEFAULT_RESULT_CACHE_CAPACITY);
+
+    std::optional<std::vector<Document>> Find(const std::string& key, uint64_t epoch);
+    void Insert(const std::string& key, uint64_t epoch, const std::vector<Document>& documents);
+
+    std::size_t size() const;
+    Stats GetStats() const;
+
+    // Ключ запроса: слова отсортированы и не повторяются, поэтому одинаковые по смыслу запросы
+    // попадают в одну запись. filter отличает поиск по статусу от поиска с предикатом
+    static std::string MakeKey(std::string_view raw_query, std::string_view filter);
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t epoch;
+        std::vector<Document> documents;
+    };
+
+    std::size_t capacity_;
+    mutable std::mutex mutex_;
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+    FrequencySketch sketch_;
+    Stats stats_;
+};
\ No newline at end of file
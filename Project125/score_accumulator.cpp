@@ -0,0 +1,11 @@
+#include "score_accumulator.h"
+
+void ScoreAccumulator::Reset(int slot_count) {
+    for (const int slot : excluded_slots_) {
+        excluded_[slot] = false;
+    }
+    excluded_slots_.clear();
+    if (static_cast<int>(excluded_.size()) < slot_count) {
+        excluded_.resize(slot_count, false);
+    }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+#include "thread_local_pool.h"
+
+// Отметки документов, исключённых минус-словами запроса, по слотам. Сбрасываются только отмеченные слоты,
+// поэтому один и тот же набор переиспользуется между запросами без выделения памяти
+class ScoreAccumulator {
+public:
+    // Набор из пула текущего потока, возвращается в пул при разрушении
+    using Lease = ThreadLocalPool<ScoreAccumulator>::Lease;
+
+    void Reset(int slot_count);
+
+    void Exclude(int slot) {
+        if (!excluded_[slot]) {
+            excluded_[slot] = true;
+            excluded_slots_.push_back(slot);
+        }
+    }
+
+    bool IsExcluded(int slot) const {
+        return excluded_[slot];
+    }
+
+private:
+    std::vector<bool> excluded_;
+    std::vector<int> excluded_slots_;
+};
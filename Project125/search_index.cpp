@@ -0,0 +1,783 @@
+#include "search_index.h"
+#include "string_processing.h"
+#include "index_file.h"
+
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <cmath>
+
+void QueryStatistics::Merge(const QueryStatistics& other) {
+	document_count += other.document_count;
+	for (const auto& [word, document_freq] : other.document_freqs) {
+		const auto it = document_freqs.find(word);
+		if (it == document_freqs.end()) {
+			document_freqs.emplace(word, document_freq);
+		}
+		else {
+			it->second += document_freq;
+		}
+	}
+}
+
+SearchIndex::key_const_iterator SearchIndex::begin() const {
+	return documents_.begin();
+}
+
+SearchIndex::key_const_iterator SearchIndex::end() const {
+	return documents_.end();
+}
+
+int SearchIndex::GetDocumentId(int index) const {
+	return documents_.GetIdAt(index);
+}
+
+void SearchIndex::SetStopWords(std::string_view stopWordsText) {
+	SetStopWords(SplitIntoWords(stopWordsText));
+}
+
+void SearchIndex::AddDocument(int documentId, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+	if (documentId < 0 || documents_.Contains(documentId)) {
+		throw std::invalid_argument("Bad document id");
+	}
+	std::vector<TermId> words;
+	if (!splitIntoWordsNoStop(document, words)) {
+		throw std::invalid_argument("Bad document data");
+	};
+	const int word_count = static_cast<int>(words.size());
+	std::sort(words.begin(), words.end());
+	TermCounts term_counts;
+	for (const TermId term : words) {
+		if (term_counts.empty() || term_counts.back().first != term) {
+			term_counts.emplace_back(term, 0);
+		}
+		++term_counts.back().second;
+	}
+	purgeTombstone(documentId);
+	addDocument(documentId, status, computeAverageRating(ratings), write_segment_->GetId(), term_counts, word_count);
+	write_segment_->AddDocument(documentId, term_counts, word_count);
+}
+
+std::vector<SearchIndex::PartialIndex> SearchIndex::PrepareDocuments(const std::vector<NewDocument>& documents) {
+	if (documents.empty()) {
+		return {};
+	}
+	const std::size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+	const std::size_t partial_count = std::max<std::size_t>(1, std::min(thread_count, documents.size() / MIN_PARTIAL_INDEX_SIZE));
+	std::vector<PartialIndex> partials(partial_count);
+	std::vector<std::size_t> indexes(partial_count);
+	std::iota(indexes.begin(), indexes.end(), 0);
+	std::for_each(std::execution::par, indexes.begin(), indexes.end(), [&](std::size_t index) {
+		const std::size_t begin = documents.size() * index / partial_count;
+		const std::size_t end = documents.size() * (index + 1) / partial_count;
+		buildPartialIndex(documents.data() + begin, documents.data() + end, partials[index]);
+	});
+	return partials;
+}
+
+void SearchIndex::CheckDocuments(const std::vector<PartialIndex>& partials) const {
+	std::unordered_set<int> batch_ids;
+	for (const PartialIndex& partial : partials) {
+		for (const PartialIndex::PreparedDocument& document : partial.documents) {
+			if (document.id < 0 || documents_.Contains(document.id) || !batch_ids.insert(document.id).second) {
+				throw std::invalid_argument("Bad document id");
+			}
+			if (!document.is_valid) {
+				throw std::invalid_argument("Bad document data");
+			}
+		}
+	}
+}
+
+void SearchIndex::BuildPartialSegments(std::vector<PartialIndex>& partials) const {
+	// Новые слова получат номера подряд после уже известных в порядке первого вхождения в пакет
+	std::unordered_map<std::string_view, TermId> new_terms;
+	TermId next_term = dictionary_.GetTermCount();
+	std::size_t document_count = 0;
+	for (PartialIndex& partial : partials) {
+		partial.terms.clear();
+		for (const std::string_view word : partial.words) {
+			TermId term = dictionary_.Find(word);
+			if (term == INVALID_TERM_ID) {
+				const auto [it, inserted] = new_terms.emplace(word, next_term);
+				next_term += inserted ? 1 : 0;
+				term = it->second;
+			}
+			partial.terms.push_back(term);
+		}
+		document_count += partial.documents.size();
+	}
+	const bool build_segments = document_count >= static_cast<std::size_t>(write_segment_capacity_);
+	std::vector<int> segment_ids(partials.size());
+	std::iota(segment_ids.begin(), segment_ids.end(), next_segment_id_);
+	std::for_each(std::execution::par, segment_ids.begin(), segment_ids.end(), [&](int segment_id) {
+		PartialIndex& partial = partials[segment_id - next_segment_id_];
+		std::shared_ptr<IndexSegment> segment = build_segments ? std::make_shared<IndexSegment>(segment_id) : nullptr;
+		for (PartialIndex::PreparedDocument& document : partial.documents) {
+			document.term_counts.clear();
+			document.word_count = 0;
+			for (const auto& [word, count] : document.word_counts) {
+				const TermId term = partial.terms[word];
+				if (!isStopWord(term)) {
+					document.term_counts.emplace_back(term, count);
+					document.word_count += count;
+				}
+			}
+			std::sort(document.term_counts.begin(), document.term_counts.end());
+			if (segment != nullptr) {
+				segment->AddDocument(document.id, document.term_counts, document.word_count);
+			}
+		}
+		if (segment != nullptr) {
+			segment->Seal();
+		}
+		partial.segment = std::move(segment);
+	});
+}
+
+void SearchIndex::AddDocuments(const std::vector<PartialIndex>& partials) {
+	for (const PartialIndex& partial : partials) {
+		for (const std::string_view word : partial.words) {
+			dictionary_.Intern(word);
+		}
+	}
+	for (const PartialIndex& partial : partials) {
+		for (const PartialIndex::PreparedDocument& document : partial.documents) {
+			if (partial.segment != nullptr) {
+				addDocument(document.id, document.status, document.rating, partial.segment->GetId(), document.term_counts, document.word_count);
+			}
+			else {
+				purgeTombstone(document.id);
+				addDocument(document.id, document.status, document.rating, write_segment_->GetId(), document.term_counts, document.word_count);
+				write_segment_->AddDocument(document.id, document.term_counts, document.word_count);
+			}
+		}
+	}
+	// Номера сегментов частей заняты, даже если сегменты не строились, так обе копии остаются одинаковыми
+	for (const PartialIndex& partial : partials) {
+		if (partial.segment != nullptr) {
+			segments_.push_back(partial.segment);
+		}
+	}
+	next_segment_id_ += static_cast<int>(partials.size());
+}
+
+uint64_t SearchIndex::GetEpoch() const {
+	return epoch_;
+}
+
+int SearchIndex::GetDocumentCount() const {
+	return documents_.size();
+}
+
+void SearchIndex::RemoveDocument(int document_id) {
+	const int slot = documents_.FindSlot(document_id);
+	if (slot == DocumentTable::NO_SLOT) {
+		return;
+	}
+	const int segment = documents_.GetSegment(slot);
+	std::vector<TermId> terms;
+	for (const auto& [term, _] : GetWordFrequencies(document_id)) {
+		terms.push_back(term);
+	}
+	document_to_word_freqs_.erase(document_id);
+	if (slot < mapped_document_count_) {
+		std::lock_guard guard(mapped_word_freqs_mutex_);
+		loaded_word_freqs_.erase(slot);
+	}
+	documents_.Remove(document_id);
+	++epoch_;
+	statistics_.RemoveDocument(terms);
+
+	if (removal_mode_ == RemovalMode::IMMEDIATE && segment == write_segment_->GetId()) {
+		write_segment_->RemoveDocuments({ { document_id, std::move(terms) } });
+	}
+	else {
+		tombstones_[segment].emplace(document_id, std::move(terms));
+	}
+}
+
+void SearchIndex::SetRemovalMode(RemovalMode mode, int compaction_threshold) {
+	removal_mode_ = mode;
+	compaction_threshold_ = compaction_threshold;
+}
+
+RemovalMode SearchIndex::GetRemovalMode() const {
+	return removal_mode_;
+}
+
+int SearchIndex::GetTombstoneCount() const {
+	int count = 0;
+	for (const auto& [segment, documents] : tombstones_) {
+		count += static_cast<int>(documents.size());
+	}
+	return count;
+}
+
+void SearchIndex::SetSegmentPolicy(int write_segment_capacity, int merge_factor) {
+	if (write_segment_capacity < 1 || merge_factor < 2) {
+		throw std::invalid_argument("Bad segment policy");
+	}
+	write_segment_capacity_ = write_segment_capacity;
+	merge_factor_ = merge_factor;
+}
+
+bool SearchIndex::IsWriteSegmentFull() const {
+	return write_segment_->GetDocumentCount() >= write_segment_capacity_;
+}
+
+std::shared_ptr<const IndexSegment> SearchIndex::BuildSealedSegment() const {
+	if (write_segment_->GetDocumentCount() == 0) {
+		return nullptr;
+	}
+	auto sealed = std::make_shared<IndexSegment>(*write_segment_);
+	sealed->Seal();
+	return sealed;
+}
+
+void SearchIndex::InstallSealedSegment(std::shared_ptr<const IndexSegment> segment) {
+	if (segment == nullptr) {
+		return;
+	}
+	segments_.push_back(std::move(segment));
+	write_segment_ = std::make_shared<IndexSegment>(next_segment_id_++);
+}
+
+std::vector<int> SearchIndex::GetCompactionSegments(bool force) const {
+	std::vector<int> segments;
+	const bool is_due = force || GetTombstoneCount() >= compaction_threshold_;
+	for (const auto& [segment, documents] : tombstones_) {
+		// Надгробия сегмента записи в режиме IMMEDIATE остаются только после смены режима
+		if (is_due || (removal_mode_ == RemovalMode::IMMEDIATE && segment == write_segment_->GetId())) {
+			segments.push_back(segment);
+		}
+	}
+	return segments;
+}
+
+std::shared_ptr<const IndexSegment> SearchIndex::BuildCompactedSegment(int segment) const {
+	if (segment == write_segment_->GetId()) {
+		return nullptr;
+	}
+	const auto it = std::find_if(segments_.begin(), segments_.end(), [segment](const auto& sealed) {
+		return sealed->GetId() == segment;
+	});
+	return IndexSegment::Merge(segment, getMergeSources({ *it }));
+}
+
+void SearchIndex::ApplyCompaction(const std::vector<int>& segments, const std::vector<std::shared_ptr<const IndexSegment>>& compacted) {
+	for (std::size_t i = 0; i < segments.size(); ++i) {
+		const int segment = segments[i];
+		const auto tombstones = tombstones_.find(segment);
+		if (segment == write_segment_->GetId()) {
+			write_segment_->RemoveDocuments(tombstones->second);
+		}
+		else {
+			const auto it = std::find_if(segments_.begin(), segments_.end(), [segment](const auto& sealed) {
+				return sealed->GetId() == segment;
+			});
+			if (compacted[i]->GetDocumentCount() == 0) {
+				segments_.erase(it);
+			}
+			else {
+				*it = compacted[i];
+			}
+		}
+		tombstones_.erase(tombstones);
+	}
+}
+
+int SearchIndex::GetSegmentCount() const {
+	return static_cast<int>(segments_.size()) + 1;
+}
+
+const std::map<TermId, double>& SearchIndex::GetWordFrequencies(int document_id) const {
+	const auto it = document_to_word_freqs_.find(document_id);
+	if (it != document_to_word_freqs_.end()) {
+		return it->second;
+	}
+	const int slot = documents_.FindSlot(document_id);
+	if (slot == DocumentTable::NO_SLOT || slot >= mapped_document_count_) {
+		return emptyMap;
+	}
+	std::lock_guard guard(mapped_word_freqs_mutex_);
+	const auto [loaded, inserted] = loaded_word_freqs_.try_emplace(slot);
+	if (inserted) {
+		for (uint64_t i = mapped_word_freq_offsets_[slot]; i < mapped_word_freq_offsets_[slot + 1]; ++i) {
+			loaded->second.emplace(mapped_word_freqs_[i].term, mapped_word_freqs_[i].frequency);
+		}
+	}
+	return loaded->second;
+}
+
+QueryStatistics SearchIndex::GetQueryStatistics(std::string_view rawQuery) const {
+	const Query query = getQuery(rawQuery);
+	QueryStatistics statistics;
+	statistics.document_count = statistics_.GetDocumentCount();
+	for (const TermId term : query.plus_words) {
+		statistics.document_freqs.emplace(dictionary_.GetTerm(term), statistics_.GetDocumentFrequency(term));
+	}
+	return statistics;
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchIndex::MatchDocument(std::string_view rawQuery, int documentId) const {
+	const Query query = getQuery(rawQuery);
+	const DocumentStatus status = getDocumentStatus(documentId);
+	const std::map<TermId, double>& word_freqs = GetWordFrequencies(documentId);
+	for (const TermId term : query.minus_words) {
+		if (word_freqs.count(term)) {
+			return { std::vector<std::string_view>(), status };
+		}
+	}
+	std::vector<TermId> matched_terms;
+	for (const TermId term : query.plus_words) {
+		if (word_freqs.count(term)) {
+			matched_terms.push_back(term);
+		}
+	}
+	return { getSortedWords(matched_terms), status };
+}
+
+SearchIndex::Query SearchIndex::getQuery(std::string_view rawQuery) const {
+	// Кэш свой у каждого потока, поэтому поиск не берёт блокировок и не меняет общее состояние.
+	// Ключ - поколение планов и текст запроса, буфер ключа переиспользуется между запросами
+	thread_local LruCache<Query> query_plans(QUERY_PLAN_CACHE_CAPACITY);
+	thread_local std::string key;
+	key.assign(reinterpret_cast<const char*>(&plan_generation_), sizeof(plan_generation_));
+	key.append(rawQuery);
+	Query query;
+	if (query_plans.Find(key, query) && (!query.has_unknown_words || query.term_count == dictionary_.GetTermCount())) {
+		return query;
+	}
+	if (!parseQuery(rawQuery, query)) {
+		throw std::invalid_argument("Bad query");
+	}
+	query_plans.Insert(key, query);
+	return query;
+}
+
+uint64_t SearchIndex::newPlanGeneration() {
+	static std::atomic<uint64_t> next_generation{ 0 };
+	return ++next_generation;
+}
+
+[[nodiscard]]
+bool SearchIndex::parseQuery(std::string_view text, Query& query) const {
+	query = Query();
+	query.term_count = dictionary_.GetTermCount();
+	for (const std::string_view word : SplitIntoWords(text)) {
+		QueryWord query_word;
+		if (!parseQueryWord(word, query_word)) {
+			return false;
+		}
+		if (query_word.term == INVALID_TERM_ID) {
+			query.has_unknown_words = true;
+		}
+		else if (!query_word.is_stop) {
+			if (query_word.is_minus) {
+				query.minus_words.push_back(query_word.term);
+			}
+			else {
+				query.plus_words.push_back(query_word.term);
+			}
+		}
+	}
+	// Слова упорядочены по тексту, а не по id: так релевантность суммируется в одном порядке
+	// на любом сервере, даже если словари шардов выдали словам разные id
+	const auto by_text = [this](TermId lhs, TermId rhs) {
+		return dictionary_.GetTerm(lhs) < dictionary_.GetTerm(rhs);
+	};
+	for (auto* words : { &query.plus_words, &query.minus_words }) {
+		std::sort(words->begin(), words->end(), by_text);
+		words->erase(std::unique(words->begin(), words->end()), words->end());
+	}
+	return true;
+}
+
+void SearchIndex::getTermWeights(const Query& query, const QueryStatistics* statistics, std::vector<TermWeight>& weights) const {
+	weights.clear();
+	for (const TermId term : query.plus_words) {
+		if (statistics_.GetDocumentFrequency(term) == 0) {
+			continue;
+		}
+		if (statistics == nullptr) {
+			weights.push_back({ term, statistics_.GetInverseDocumentFreq(term) });
+		}
+		else {
+			const auto it = statistics->document_freqs.find(dictionary_.GetTerm(term));
+			const int document_freq = it == statistics->document_freqs.end() ? 0 : it->second;
+			if (document_freq > 0) {
+				weights.push_back({ term, CorpusStatistics::ComputeInverseDocumentFreq(statistics->document_count, document_freq) });
+			}
+		}
+	}
+}
+
+[[nodiscard]]
+bool SearchIndex::parseQueryWord(std::string_view text, QueryWord& qw) const {
+	if (text.empty()) {
+		return false;
+	}
+	bool is_minus = false;
+	if (text[0] == '-') {
+		is_minus = true;
+		text.remove_prefix(1);
+	}
+	if (!isValidWord(text)) {
+		return false;
+	}
+	const TermId term = dictionary_.Find(text);
+	qw = { term, is_minus, term != INVALID_TERM_ID && isStopWord(term) };
+	return true;
+}
+
+int SearchIndex::computeAverageRating(const std::vector<int>& ratings) {
+	int ratingsCount = static_cast<int>(ratings.size());
+	if (ratingsCount == 0) {
+		return 0;
+	}
+	else {
+		int rating_sum = std::accumulate(ratings.cbegin(), ratings.cend(), 0);
+		return rating_sum / static_cast<int>(ratings.size());
+	}
+}
+
+void SearchIndex::buildPartialIndex(const NewDocument* begin, const NewDocument* end, PartialIndex& partial) {
+	std::unordered_map<std::string_view, int> word_indexes;
+	// Для каждого слова части: последний документ, в котором оно встретилось, и его позиция в word_counts этого документа
+	std::vector<std::pair<std::size_t, std::size_t>> last_positions;
+	std::vector<std::string_view> words;
+	partial.documents.reserve(end - begin);
+	for (const NewDocument* document = begin; document != end; ++document) {
+		PartialIndex::PreparedDocument& prepared = partial.documents.emplace_back();
+		prepared.id = document->id;
+		prepared.status = document->status;
+		prepared.rating = computeAverageRating(document->ratings);
+		words.clear();
+		prepared.is_valid = SplitIntoValidWords(document->text, words);
+		if (!prepared.is_valid) {
+			continue;
+		}
+		const std::size_t document_number = partial.documents.size();
+		for (const std::string_view word : words) {
+			const auto [it, inserted] = word_indexes.emplace(word, static_cast<int>(partial.words.size()));
+			if (inserted) {
+				partial.words.push_back(word);
+				last_positions.emplace_back(0, 0);
+			}
+			auto& [last_document, position] = last_positions[it->second];
+			if (last_document != document_number) {
+				last_document = document_number;
+				position = prepared.word_counts.size();
+				prepared.word_counts.emplace_back(it->second, 0);
+			}
+			++prepared.word_counts[position].second;
+		}
+	}
+}
+
+void SearchIndex::addDocument(int document_id, DocumentStatus status, int rating, int segment, const TermCounts& term_counts, int word_count) {
+	const int slot = documents_.Add(document_id, rating, status, word_count);
+	documents_.SetSegment(slot, segment);
+	calculateTermFrequency(document_id, term_counts, word_count);
+	++epoch_;
+}
+
+void SearchIndex::calculateTermFrequency(int documentId, const TermCounts& term_counts, int word_count) {
+	const double inv_word_count = 1.0 / word_count;
+	std::vector<TermId> terms;
+	terms.reserve(term_counts.size());
+	if (!term_counts.empty()) {
+		std::map<TermId, double>& word_freqs = document_to_word_freqs_[documentId];
+		for (const auto& [term, count] : term_counts) {
+			word_freqs.emplace_hint(word_freqs.end(), term, count * inv_word_count);
+			terms.push_back(term);
+		}
+	}
+	growTermIndex();
+	statistics_.AddDocument(terms);
+}
+
+DocumentStatus SearchIndex::getDocumentStatus(int document_id) const {
+	const int slot = documents_.FindSlot(document_id);
+	if (slot == DocumentTable::NO_SLOT) {
+		throw std::out_of_range("Bad document id");
+	}
+	return documents_.GetStatus(slot);
+}
+
+std::vector<std::string_view> SearchIndex::getSortedWords(const std::vector<TermId>& terms) const {
+	std::vector<std::string_view> words;
+	words.reserve(terms.size());
+	for (const TermId term : terms) {
+		words.push_back(dictionary_.GetTerm(term));
+	}
+	std::sort(words.begin(), words.end());
+	return words;
+}
+
+void SearchIndex::growTermIndex() {
+	statistics_.Resize(dictionary_.GetTermCount());
+	m_stopWords.resize(dictionary_.GetTermCount(), false);
+}
+
+void SearchIndex::purgeTombstone(int document_id) {
+	// Надгробия в запечатанных сегментах не мешают: новый документ с тем же id лежит в сегменте записи
+	const auto tombstones = tombstones_.find(write_segment_->GetId());
+	if (tombstones == tombstones_.end()) {
+		return;
+	}
+	const auto it = tombstones->second.find(document_id);
+	if (it == tombstones->second.end()) {
+		return;
+	}
+	write_segment_->RemoveDocuments({ *it });
+	tombstones->second.erase(it);
+	if (tombstones->second.empty()) {
+		tombstones_.erase(tombstones);
+	}
+}
+
+std::vector<int> SearchIndex::PickMergeSegments() const {
+	// Ярус сегмента - во сколько раз по степеням merge_factor число его живых документов больше ёмкости
+	// сегмента записи. Сегмент, в котором удалена больше половины документов, переписывается отдельно
+	std::map<int, std::vector<int>> tiers;
+	for (const auto& segment : segments_) {
+		const auto tombstones = tombstones_.find(segment->GetId());
+		const int removed = tombstones == tombstones_.end() ? 0 : static_cast<int>(tombstones->second.size());
+		if (removed * 2 > segment->GetDocumentCount()) {
+			return { segment->GetId() };
+		}
+		const long long live = segment->GetDocumentCount() - removed;
+		int tier = 0;
+		for (long long size = write_segment_capacity_; size < live; size *= merge_factor_) {
+			++tier;
+		}
+		std::vector<int>& tier_segments = tiers[tier];
+		tier_segments.push_back(segment->GetId());
+		if (static_cast<int>(tier_segments.size()) == merge_factor_) {
+			return tier_segments;
+		}
+	}
+	return {};
+}
+
+int SearchIndex::BeginMerge(const std::vector<int>& segments) {
+	merging_segments_ = segments;
+	merged_segment_id_ = next_segment_id_++;
+	return merged_segment_id_;
+}
+
+std::vector<IndexSegment::MergeSource> SearchIndex::GetMergeSources() const {
+	std::vector<std::shared_ptr<const IndexSegment>> segments;
+	for (const auto& segment : segments_) {
+		if (IsMerging(segment->GetId())) {
+			segments.push_back(segment);
+		}
+	}
+	return getMergeSources(segments);
+}
+
+void SearchIndex::FinishMerge(std::shared_ptr<const IndexSegment> merged) {
+	const std::vector<int>& document_ids = merged->GetDocumentIds();
+
+	// Документы, удалённые во время слияния, попали в новый сегмент и остаются в нём надгробиями
+	std::map<int, std::vector<TermId>> merged_tombstones;
+	for (const int segment : merging_segments_) {
+		const auto tombstones = tombstones_.find(segment);
+		if (tombstones == tombstones_.end()) {
+			continue;
+		}
+		for (auto& [document_id, terms] : tombstones->second) {
+			if (std::binary_search(document_ids.begin(), document_ids.end(), document_id)) {
+				merged_tombstones.emplace(document_id, std::move(terms));
+			}
+		}
+		tombstones_.erase(tombstones);
+	}
+	if (!merged_tombstones.empty()) {
+		tombstones_.emplace(merged->GetId(), std::move(merged_tombstones));
+	}
+	for (const int document_id : document_ids) {
+		const int slot = documents_.FindSlot(document_id);
+		if (slot != DocumentTable::NO_SLOT && IsMerging(documents_.GetSegment(slot))) {
+			documents_.SetSegment(slot, merged->GetId());
+		}
+	}
+
+	const auto first = std::find_if(segments_.begin(), segments_.end(), [this](const auto& segment) {
+		return IsMerging(segment->GetId());
+	});
+	const auto position = first - segments_.begin();
+	segments_.erase(std::remove_if(segments_.begin(), segments_.end(), [this](const auto& segment) {
+		return IsMerging(segment->GetId());
+	}), segments_.end());
+	if (merged->GetDocumentCount() > 0) {
+		segments_.insert(segments_.begin() + position, std::move(merged));
+	}
+	merging_segments_.clear();
+}
+
+void SearchIndex::Save(const std::string& path, uint64_t log_sequence) const {
+	IndexFileWriter writer;
+	{
+		SectionWriter out(writer.AddSection(IndexSection::LOG_SEQUENCE));
+		out.Write(log_sequence);
+	}
+	{
+		SectionWriter out(writer.AddSection(IndexSection::STOP_WORDS));
+		std::vector<TermId> stop_words;
+		for (TermId term = 0; term < static_cast<TermId>(m_stopWords.size()); ++term) {
+			if (m_stopWords[term]) {
+				stop_words.push_back(term);
+			}
+		}
+		out.Write<uint64_t>(stop_words.size());
+		out.WriteArray(stop_words.data(), stop_words.size());
+	}
+	{
+		SectionWriter out(writer.AddSection(IndexSection::DICTIONARY));
+		dictionary_.Save(out);
+	}
+	{
+		SectionWriter out(writer.AddSection(IndexSection::DOCUMENTS));
+		documents_.Save(out);
+	}
+	{
+		SectionWriter out(writer.AddSection(IndexSection::STATISTICS));
+		statistics_.Save(out);
+	}
+	{
+		// Все сегменты сливаются в один, удалённые документы в него не попадают
+		std::vector<std::shared_ptr<const IndexSegment>> segments = segments_;
+		segments.push_back(write_segment_);
+		SectionWriter out(writer.AddSection(IndexSection::POSTINGS));
+		IndexSegment::Merge(0, getMergeSources(segments))->Save(out, dictionary_.GetTermCount());
+	}
+	{
+		std::vector<uint64_t> offsets = { 0 };
+		std::vector<MappedWordFrequency> frequencies;
+		for (const int document_id : documents_) {
+			for (const auto& [term, frequency] : GetWordFrequencies(document_id)) {
+				frequencies.push_back({ term, 0, frequency });
+			}
+			offsets.push_back(frequencies.size());
+		}
+		SectionWriter out(writer.AddSection(IndexSection::WORD_FREQUENCIES));
+		out.Write<uint64_t>(documents_.size());
+		out.Write<uint64_t>(frequencies.size());
+		out.WriteArray(offsets.data(), offsets.size());
+		out.WriteArray(frequencies.data(), frequencies.size());
+	}
+	writer.Write(path);
+}
+
+void SearchIndex::Load(std::shared_ptr<const IndexFile> file) {
+	// Файл разбирается целиком до изменения индекса, чтобы ошибка не оставила копии индекса разными
+	TermDictionary dictionary;
+	SectionReader dictionary_in(file->GetSection(IndexSection::DICTIONARY));
+	dictionary.Map(dictionary_in);
+
+	std::vector<bool> stop_words(dictionary.GetTermCount(), false);
+	SectionReader stop_words_in(file->GetSection(IndexSection::STOP_WORDS));
+	const uint64_t stop_word_count = stop_words_in.Read<uint64_t>();
+	const TermId* stop_word_terms = stop_words_in.ReadArray<TermId>(stop_word_count);
+	for (uint64_t i = 0; i < stop_word_count; ++i) {
+		if (stop_word_terms[i] < 0 || stop_word_terms[i] >= dictionary.GetTermCount()) {
+			throw std::runtime_error("Bad index file: unknown stop word");
+		}
+		stop_words[stop_word_terms[i]] = true;
+	}
+
+	CorpusStatistics statistics;
+	SectionReader statistics_in(file->GetSection(IndexSection::STATISTICS));
+	statistics.Load(statistics_in);
+	statistics.Resize(dictionary.GetTermCount());
+
+	DocumentTable documents;
+	SectionReader documents_in(file->GetSection(IndexSection::DOCUMENTS));
+	documents.Load(documents_in, MAPPED_SEGMENT_ID);
+
+	SectionReader postings_in(file->GetSection(IndexSection::POSTINGS));
+	std::shared_ptr<const IndexSegment> segment = IndexSegment::Map(MAPPED_SEGMENT_ID, postings_in, file);
+
+	SectionReader word_freqs_in(file->GetSection(IndexSection::WORD_FREQUENCIES));
+	const uint64_t document_count = word_freqs_in.Read<uint64_t>();
+	const uint64_t frequency_count = word_freqs_in.Read<uint64_t>();
+	if (document_count != static_cast<uint64_t>(documents.size())) {
+		throw std::runtime_error("Bad index file: document count mismatch");
+	}
+	const uint64_t* word_freq_offsets = word_freqs_in.ReadArray<uint64_t>(document_count + 1);
+	const MappedWordFrequency* word_freqs = word_freqs_in.ReadArray<MappedWordFrequency>(frequency_count);
+
+	retired_.push_back(std::make_shared<const TermDictionary>(std::move(dictionary_)));
+	if (file_) {
+		retired_.push_back(std::move(file_));
+	}
+	dictionary_ = std::move(dictionary);
+	m_stopWords = std::move(stop_words);
+	statistics_ = std::move(statistics);
+	documents_ = std::move(documents);
+	document_to_word_freqs_.clear();
+	segments_.clear();
+	if (segment->GetDocumentCount() > 0) {
+		segments_.push_back(std::move(segment));
+	}
+	write_segment_ = std::make_shared<IndexSegment>(0);
+	next_segment_id_ = MAPPED_SEGMENT_ID + 1;
+	tombstones_.clear();
+	merging_segments_.clear();
+	{
+		std::lock_guard guard(mapped_word_freqs_mutex_);
+		loaded_word_freqs_.clear();
+	}
+	mapped_document_count_ = static_cast<int>(document_count);
+	mapped_word_freq_offsets_ = word_freq_offsets;
+	mapped_word_freqs_ = word_freqs;
+	file_ = std::move(file);
+	plan_generation_ = newPlanGeneration();
+	++epoch_;
+}
+
+bool SearchIndex::IsMerging(int segment) const {
+	return std::find(merging_segments_.begin(), merging_segments_.end(), segment) != merging_segments_.end();
+}
+
+std::vector<IndexSegment::MergeSource> SearchIndex::getMergeSources(const std::vector<std::shared_ptr<const IndexSegment>>& segments) const {
+	std::vector<IndexSegment::MergeSource> sources;
+	for (const auto& segment : segments) {
+		IndexSegment::MergeSource& source = sources.emplace_back();
+		source.segment = segment;
+		for (const int document_id : segment->GetDocumentIds()) {
+			const int slot = findLiveSlot(segment->GetId(), document_id);
+			if (slot != DocumentTable::NO_SLOT) {
+				source.live_documents.emplace_back(document_id, documents_.GetWordCount(slot));
+			}
+		}
+		// Id документов сегмента записи не отсортированы
+		std::sort(source.live_documents.begin(), source.live_documents.end());
+	}
+	return sources;
+}
+
+bool SearchIndex::splitIntoWordsNoStop(std::string_view text, std::vector<TermId>& words) {
+	std::vector<std::string_view> tempWords;
+	if (!SplitIntoValidWords(text, tempWords)) {
+		return false;
+	}
+	words.reserve(tempWords.size());
+	for (const std::string_view word : tempWords) {
+		const TermId term = dictionary_.Intern(word);
+		if (!isStopWord(term)) {
+			words.push_back(term);
+		}
+	}
+	return true;
+}
+
+bool SearchIndex::isValidWord(std::string_view word) {
+	return IsValidWord(word);
+}
+
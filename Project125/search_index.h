@@ -0,0 +1,571 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <set>
+#include <algorithm>
+#include <stdexcept>
+#include <map>
+#include <cmath>
+#include <limits>
+#include <execution>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+
+#include "corpus_statistics.h"
+#include "document.h"
+#include "document_table.h"
+#include "index_file.h"
+#include "index_segment.h"
+#include "lru_cache.h"
+#include "posting_cursor.h"
+#include "posting_list.h"
+#include "score_accumulator.h"
+#include "small_vector.h"
+#include "string_processing.h"
+#include "term_dictionary.h"
+#include "thread_local_pool.h"
+#include "top_documents.h"
+#include "utility.h"
+
+const int MAX_RESULT_DOCUMENT_COUNT = 5;
+const int DEFAULT_COMPACTION_THRESHOLD = 1024;
+const std::size_t QUERY_PLAN_CACHE_CAPACITY = 1024;
+const int DEFAULT_WRITE_SEGMENT_CAPACITY = 1024;
+const int DEFAULT_MERGE_FACTOR = 4;
+
+enum class RemovalMode {
+    IMMEDIATE,
+    TOMBSTONE,
+};
+
+// Число документов и документные частоты плюс-слов запроса. Сумма статистик всех шардов
+// позволяет каждому шарду считать IDF так же, как сервер со всеми документами
+struct QueryStatistics {
+    int document_count = 0;
+    std::map<std::string, int, std::less<>> document_freqs;
+
+    void Merge(const QueryStatistics& other);
+};
+
+// Документ для пакетного добавления. Текст должен жить, пока идёт добавление
+struct NewDocument {
+    int id = 0;
+    std::string_view text;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+};
+
+// Одна версия поискового индекса: словарь, таблица документов, статистика и сегменты. Сама по себе
+// не потокобезопасна и не строит сегменты в фоне: изменения вносит SearchServer, который держит
+// две копии индекса. Каждое изменение детерминировано, поэтому обе копии проходят одинаковые состояния,
+// а запечатанные и слитые сегменты строятся один раз и разделяются копиями
+class SearchIndex {
+public:
+    typedef DocumentTable::const_iterator key_const_iterator;
+
+    key_const_iterator begin() const;
+    key_const_iterator end() const;
+
+    // Стоп-слова проверяются все до изменения индекса, чтобы ошибка не оставила копии индекса разными
+    template <typename StringContainer, typename = std::enable_if_t<!std::is_convertible_v<const StringContainer&, std::string_view>>>
+    void SetStopWords(const StringContainer& stopWords) {
+        for (const auto& stopWord : stopWords) {
+            if (!isValidWord(stopWord)) {
+                throw std::invalid_argument("Bad stop word");
+            }
+        }
+        std::vector<TermId> terms;
+        for (const auto& stopWord : stopWords) {
+            terms.push_back(dictionary_.Intern(stopWord));
+        }
+        growTermIndex();
+        for (const TermId term : terms) {
+            m_stopWords[term] = true;
+        }
+        plan_generation_ = newPlanGeneration();
+        ++epoch_;
+    }
+
+    void SetStopWords(std::string_view stopWordsText);
+
+    void AddDocument(int documentId, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+
+    // Часть пакета документов. Слова части пронумерованы в порядке первого вхождения, документ хранит
+    // номера своих слов в том же порядке и число вхождений каждого
+    struct PartialIndex {
+        struct PreparedDocument {
+            int id = 0;
+            DocumentStatus status = DocumentStatus::ACTUAL;
+            int rating = 0;
+            bool is_valid = true;
+            std::vector<std::pair<int, int>> word_counts;
+            // Заполняются BuildPartialSegments
+            TermCounts term_counts;
+            int word_count = 0;
+        };
+
+        std::vector<std::string_view> words;
+        std::vector<PreparedDocument> documents;
+        // Номера, которые слова части получат в словаре
+        std::vector<TermId> terms;
+        // Запечатанный сегмент с документами части, если пакет не меньше сегмента записи
+        std::shared_ptr<const IndexSegment> segment;
+    };
+
+    // Делит пакет на части по числу потоков и разбирает их на слова параллельно, без обращения к индексу
+    static std::vector<PartialIndex> PrepareDocuments(const std::vector<NewDocument>& documents);
+    // Бросает то же исключение, что AddDocument для первого документа пакета, который нельзя добавить
+    void CheckDocuments(const std::vector<PartialIndex>& partials) const;
+    // Нумерует слова частей так, как их пронумерует словарь, считает вхождения слов документов без стоп-слов
+    // и, если пакет не меньше сегмента записи, параллельно строит по запечатанному сегменту на часть.
+    // Индекс не меняется, поэтому эта работа делается один раз для обеих копий
+    void BuildPartialSegments(std::vector<PartialIndex>& partials) const;
+    // Сливает части в индекс по порядку. Слова вносятся в словарь в порядке первого вхождения в пакет,
+    // поэтому номера слов те же, что при добавлении документов пакета по одному
+    void AddDocuments(const std::vector<PartialIndex>& partials);
+
+    // Удаляет документ из таблицы. Вхождения из сегмента записи в режиме IMMEDIATE стираются сразу,
+    // в остальных случаях остаются надгробием до уплотнения или слияния
+    void RemoveDocument(int document_id);
+
+    void SetRemovalMode(RemovalMode mode, int compaction_threshold);
+    RemovalMode GetRemovalMode() const;
+    int GetTombstoneCount() const;
+
+    void SetSegmentPolicy(int write_segment_capacity, int merge_factor);
+    int GetSegmentCount() const;
+
+    bool IsWriteSegmentFull() const;
+    std::shared_ptr<const IndexSegment> BuildSealedSegment() const;
+    void InstallSealedSegment(std::shared_ptr<const IndexSegment> segment);
+
+    // Сегменты, надгробия которых пора убрать: все сразу, когда надгробий набралось compaction_threshold,
+    // или если force. Запечатанный сегмент переписывается целиком, поэтому удаление из него и в режиме
+    // IMMEDIATE только ставит надгробие; сегмент записи в режиме IMMEDIATE уплотняется сразу
+    std::vector<int> GetCompactionSegments(bool force) const;
+    // Новая версия запечатанного сегмента с тем же id из его живых документов. Списки вхождений читаются
+    // по порядку, как при слиянии, и отображённый сегмент не копируется в память целиком
+    std::shared_ptr<const IndexSegment> BuildCompactedSegment(int segment) const;
+    // Сегмент записи уплотняется на месте, запечатанные заменяются готовыми копиями без удалённых документов
+    void ApplyCompaction(const std::vector<int>& segments, const std::vector<std::shared_ptr<const IndexSegment>>& compacted);
+
+    std::vector<int> PickMergeSegments() const;
+    // Запоминает сливаемые сегменты и возвращает id будущего сегмента
+    int BeginMerge(const std::vector<int>& segments);
+    std::vector<IndexSegment::MergeSource> GetMergeSources() const;
+    void FinishMerge(std::shared_ptr<const IndexSegment> merged);
+    bool IsMerging(int segment) const;
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view rawQuery, const DocumentPredicate& document_predicate, int max_count) const {
+        const Query query = getQuery(rawQuery);
+        TopDocuments top_documents(max_count);
+        TermWeightsLease weights;
+        getTermWeights(query, nullptr, *weights);
+        findAllDocuments(query, *weights, document_predicate, top_documents);
+        return top_documents.Extract();
+    }
+
+    // То же без выделения памяти под результат: до max_count документов записываются в output
+    template <typename DocumentPredicate>
+    int FindTopDocuments(std::string_view rawQuery, const DocumentPredicate& document_predicate, int max_count, Document* output) const {
+        const Query query = getQuery(rawQuery);
+        TopDocuments::Lease lease;
+        TopDocuments& top_documents = *lease;
+        top_documents.Reset(max_count);
+        TermWeightsLease weights;
+        getTermWeights(query, nullptr, *weights);
+        findAllDocuments(query, *weights, document_predicate, top_documents);
+        return top_documents.ExtractTo(output);
+    }
+
+    // Поиск с IDF по внешней статистике корпуса, например по сумме статистик всех шардов
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view rawQuery, const QueryStatistics& statistics, const DocumentPredicate& document_predicate, int max_count) const {
+        const Query query = getQuery(rawQuery);
+        TopDocuments top_documents(max_count);
+        TermWeightsLease weights;
+        getTermWeights(query, &statistics, *weights);
+        findAllDocuments(query, *weights, document_predicate, top_documents);
+        return top_documents.Extract();
+    }
+
+    template <typename ExecutionPolicy, typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view rawQuery, const DocumentPredicate& document_predicate, int max_count) const {
+        const Query query = getQuery(rawQuery);
+        TopDocuments top_documents(max_count);
+        TermWeightsLease weights;
+        getTermWeights(query, nullptr, *weights);
+        findAllDocuments(policy, query, *weights, document_predicate, top_documents);
+        return top_documents.Extract();
+    }
+
+    QueryStatistics GetQueryStatistics(std::string_view rawQuery) const;
+
+    // Сохраняет индекс одним сегментом без удалённых документов. log_sequence - номер последней
+    // записи журнала изменений, которая вошла в снимок
+    void Save(const std::string& path, uint64_t log_sequence = 0) const;
+    // Заменяет содержимое индекса файлом: списки вхождений и слова читаются из отображённой памяти,
+    // частоты слов документа раскладываются при первом обращении к нему. Прежние словарь и файл
+    // остаются в памяти до разрушения индекса
+    void Load(std::shared_ptr<const IndexFile> file);
+
+    const std::map<TermId, double>& GetWordFrequencies(int document_id) const;
+
+    int GetDocumentCount() const;
+    int GetDocumentId(int index) const;
+
+    uint64_t GetEpoch() const;
+
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view rawQuery, int documentId) const;
+
+    template <typename ExecutionPolicy>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(ExecutionPolicy&& policy, std::string_view rawQuery, int documentId) const {
+        const Query query = getQuery(rawQuery);
+        const DocumentStatus status = getDocumentStatus(documentId);
+        const std::map<TermId, double>& word_freqs = GetWordFrequencies(documentId);
+        const auto contains = [&word_freqs](TermId term) {
+            return word_freqs.count(term) > 0;
+        };
+        if (std::any_of(policy, query.minus_words.begin(), query.minus_words.end(), contains)) {
+            return { std::vector<std::string_view>(), status };
+        }
+        std::vector<TermId> matched_terms(query.plus_words.size());
+        matched_terms.erase(std::copy_if(policy, query.plus_words.begin(), query.plus_words.end(), matched_terms.begin(), contains), matched_terms.end());
+        return { getSortedWords(matched_terms), status };
+    }
+
+private:
+
+    static constexpr std::size_t QUERY_INLINE_TERM_COUNT = 8;
+
+    // Скомпилированный запрос: плюс- и минус-слова отсортированы по тексту и не повторяются.
+    // Незнакомые слова в план не попадают, поэтому такой план годен, пока словарь не вырос
+    struct Query {
+        SmallVector<TermId, QUERY_INLINE_TERM_COUNT> plus_words;
+        SmallVector<TermId, QUERY_INLINE_TERM_COUNT> minus_words;
+        bool has_unknown_words = false;
+        int term_count = 0;
+    };
+
+    // Плюс-слово, которое есть в живых документах, и его IDF
+    struct TermWeight {
+        TermId term;
+        double inverse_document_freq;
+    };
+
+    // Веса слов запроса из пула потока: память переиспользуется между запросами
+    using TermWeightsLease = ThreadLocalPool<std::vector<TermWeight>>::Lease;
+
+    // Буферы поиска по сегменту из пула потока. Для каждого сегмента они очищаются, а не создаются заново
+    struct SegmentSearchBuffers {
+        using Lease = ThreadLocalPool<SegmentSearchBuffers>::Lease;
+
+        std::vector<PostingCursor> cursors;
+        std::vector<std::size_t> order;
+        std::vector<double> window_scores;
+        std::vector<double> max_score_sums;
+        std::vector<double> term_scores;
+    };
+
+    struct MappedWordFrequency {
+        TermId term;
+        int reserved;
+        double frequency;
+    };
+
+    static constexpr int MAPPED_SEGMENT_ID = 1;
+    // Меньшие части не окупают отдельный поток
+    static constexpr std::size_t MIN_PARTIAL_INDEX_SIZE = 64;
+
+    // Меньшие диапазоны не окупают отдельную задачу; диапазонов больше, чем потоков, чтобы выровнять нагрузку
+    static constexpr int MIN_SEARCH_RANGE_SIZE = 128;
+    static constexpr int SEARCH_RANGES_PER_THREAD = 4;
+
+    struct QueryWord {
+        TermId term;
+        bool is_minus;
+        bool is_stop;
+    };
+
+    TermDictionary dictionary_;
+    // Признак стоп-слова по id слова: проверка каждого слова текста - одно чтение бита
+    std::vector<bool> m_stopWords;
+    CorpusStatistics statistics_;
+    std::map<int, std::map<TermId, double>> document_to_word_freqs_;
+    DocumentTable documents_;
+    RemovalMode removal_mode_ = RemovalMode::IMMEDIATE;
+    int compaction_threshold_ = DEFAULT_COMPACTION_THRESHOLD;
+
+    // Запечатанные сегменты от старых к новым и изменяемый сегмент записи
+    std::vector<std::shared_ptr<const IndexSegment>> segments_;
+    std::shared_ptr<IndexSegment> write_segment_ = std::make_shared<IndexSegment>(0);
+    int next_segment_id_ = 1;
+    int write_segment_capacity_ = DEFAULT_WRITE_SEGMENT_CAPACITY;
+    int merge_factor_ = DEFAULT_MERGE_FACTOR;
+    // Удалённые документы, вхождения которых ещё лежат в сегментах: id сегмента -> id документа -> его слова
+    std::map<int, std::map<int, std::vector<TermId>>> tombstones_;
+    std::vector<int> merging_segments_;
+    int merged_segment_id_ = 0;
+    std::map<TermId, double> emptyMap;
+    // Частоты слов документов из файла: документ из слота s записан в файле под номером s
+    std::shared_ptr<const IndexFile> file_;
+    int mapped_document_count_ = 0;
+    const uint64_t* mapped_word_freq_offsets_ = nullptr;
+    const MappedWordFrequency* mapped_word_freqs_ = nullptr;
+    mutable std::mutex mapped_word_freqs_mutex_;
+    mutable std::map<int, std::map<TermId, double>> loaded_word_freqs_;
+    // Словари и файлы, заменённые при Load. Слова из MatchDocument указывают в них, поэтому они живут
+    // вместе с индексом
+    std::vector<std::shared_ptr<const void>> retired_;
+    uint64_t epoch_ = 0;
+    // Планы запросов кэшируются в каждом потоке по поколению планов индекса. Поколение уникально
+    // для каждой копии индекса и меняется вместе со стоп-словами и словарём
+    uint64_t plan_generation_ = newPlanGeneration();
+
+    static uint64_t newPlanGeneration();
+
+    Query getQuery(std::string_view rawQuery) const;
+
+    std::vector<IndexSegment::MergeSource> getMergeSources(const std::vector<std::shared_ptr<const IndexSegment>>& segments) const;
+
+    void getTermWeights(const Query& query, const QueryStatistics* statistics, std::vector<TermWeight>& weights) const;
+
+    [[nodiscard]]
+    bool parseQuery(std::string_view text, Query& query) const;
+
+    [[nodiscard]]
+    bool parseQueryWord(std::string_view text, QueryWord& qw) const;
+
+    static int computeAverageRating(const std::vector<int>& ratings);
+
+    static void buildPartialIndex(const NewDocument* begin, const NewDocument* end, PartialIndex& partial);
+
+    void addDocument(int document_id, DocumentStatus status, int rating, int segment, const TermCounts& term_counts, int word_count);
+    void calculateTermFrequency(int documentId, const TermCounts& term_counts, int word_count);
+
+    void growTermIndex();
+
+    DocumentStatus getDocumentStatus(int document_id) const;
+
+    std::vector<std::string_view> getSortedWords(const std::vector<TermId>& terms) const;
+
+    void purgeTombstone(int document_id);
+
+
+    // Слот документа, если его действующие вхождения лежат в этом сегменте. Вхождения удалённых
+    // и заново добавленных документов остаются в старых сегментах до слияния, но не находятся
+    int findLiveSlot(int segment, int document_id) const {
+        const int slot = documents_.FindSlot(document_id);
+        return slot != DocumentTable::NO_SLOT && documents_.GetSegment(slot) == segment ? slot : DocumentTable::NO_SLOT;
+    }
+
+    template <typename Function>
+    void forEachSegment(Function function) const {
+        for (const auto& segment : segments_) {
+            function(*segment);
+        }
+        function(*write_segment_);
+    }
+
+    bool splitIntoWordsNoStop(std::string_view text, std::vector<TermId>& words);
+
+    static bool isValidWord(std::string_view word);
+
+    // Слова, добавленные в словарь после последнего growTermIndex, не стоп-слова
+    bool isStopWord(TermId term) const {
+        return term < static_cast<TermId>(m_stopWords.size()) && m_stopWords[term];
+    }
+
+    // Поиск документ за документом (MaxScore по блокам). Документы перебираются окнами, в пределах
+    // которых вклад каждого слова ограничен весом его текущего блока, умноженным на IDF. Слова, сумма
+    // оценок которых не дотягивает до худшего из отобранных документов, не порождают кандидатов,
+    // а проверяются только для уже найденных; окно, где порог недостижим, пропускается целиком
+    // Документ лежит ровно в одном сегменте, поэтому сегменты просматриваются по очереди с общим
+    // набором лучших документов, и порог отсечения, набранный в одном сегменте, работает в следующих
+    template <typename DocumentPredicate>
+    void findAllDocuments(const Query& query, const std::vector<TermWeight>& weights, DocumentPredicate document_predicate, TopDocuments& top_documents) const {
+        findRangeDocuments(query, weights, document_predicate, std::numeric_limits<int>::min(), PostingCursor::END_DOCUMENT_ID, top_documents);
+    }
+
+    // То же среди документов с id из [first_document_id, end_document_id)
+    template <typename DocumentPredicate>
+    void findRangeDocuments(const Query& query, const std::vector<TermWeight>& weights, DocumentPredicate& document_predicate, int first_document_id, int end_document_id, TopDocuments& top_documents) const {
+        ScoreAccumulator::Lease lease;
+        ScoreAccumulator& excluded = *lease;
+        excluded.Reset(documents_.GetSlotCount());
+        SegmentSearchBuffers::Lease buffers;
+        forEachSegment([&](const IndexSegment& segment) {
+            findSegmentDocuments(segment, query, weights, document_predicate, first_document_id, end_document_id, excluded, *buffers, top_documents);
+        });
+    }
+
+    template <typename DocumentPredicate>
+    void findSegmentDocuments(const IndexSegment& segment, const Query& query, const std::vector<TermWeight>& weights, DocumentPredicate& document_predicate,
+        int first_document_id, int end_document_id, ScoreAccumulator& excluded, SegmentSearchBuffers& buffers, TopDocuments& top_documents) const {
+        const int segment_id = segment.GetId();
+        for (const TermId term : query.minus_words) {
+            const PostingListView postings = segment.Find(term);
+            auto it = postings.begin();
+            for (it.SkipTo(first_document_id); it != postings.end() && it->document_id < end_document_id; ++it) {
+                const int slot = findLiveSlot(segment_id, it->document_id);
+                if (slot != DocumentTable::NO_SLOT) {
+                    excluded.Exclude(slot);
+                }
+            }
+        }
+
+        std::vector<PostingCursor>& cursors = buffers.cursors;
+        cursors.clear();
+        for (const TermWeight& weight : weights) {
+            const PostingListView postings = segment.Find(weight.term);
+            if (!postings.empty()) {
+                cursors.emplace_back(postings, weight.inverse_document_freq);
+                cursors.back().SkipTo(first_document_id);
+            }
+        }
+        const std::size_t cursor_count = cursors.size();
+        // order - курсоры по возрастанию оценки в окне, max_score_sums[i] - сумма оценок order[0..i].
+        // Вклады слов собираются в term_scores в порядке запроса, чтобы релевантность суммировалась
+        // в том же порядке, что и при полном переборе
+        std::vector<std::size_t>& order = buffers.order;
+        std::vector<double>& window_scores = buffers.window_scores;
+        std::vector<double>& max_score_sums = buffers.max_score_sums;
+        std::vector<double>& term_scores = buffers.term_scores;
+        order.assign(cursor_count, 0);
+        window_scores.assign(cursor_count, 0.0);
+        max_score_sums.assign(cursor_count, 0.0);
+        term_scores.assign(cursor_count, 0.0);
+        const auto get_threshold = [&top_documents]() {
+            if (top_documents.size() == 0 || !top_documents.IsFull()) {
+                return -std::numeric_limits<double>::infinity();
+            }
+            return top_documents.GetWorst().relevance - EPSILON;
+        };
+
+        while (true) {
+            int window_begin = PostingCursor::END_DOCUMENT_ID;
+            for (const PostingCursor& cursor : cursors) {
+                window_begin = std::min(window_begin, cursor.GetDocumentId());
+            }
+            if (window_begin >= end_document_id) {
+                break;
+            }
+            int window_end = end_document_id - 1;
+            for (PostingCursor& cursor : cursors) {
+                if (cursor.ShallowSkipTo(window_begin)) {
+                    window_end = std::min(window_end, cursor.GetBlockLastDocumentId());
+                }
+            }
+            for (std::size_t i = 0; i < cursor_count; ++i) {
+                const bool in_window = cursors[i].GetDocumentId() != PostingCursor::END_DOCUMENT_ID && cursors[i].GetBlockFirstDocumentId() <= window_end;
+                window_scores[i] = in_window ? cursors[i].GetBlockMaxScore() : 0.0;
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [&window_scores](std::size_t lhs, std::size_t rhs) {
+                return window_scores[lhs] < window_scores[rhs];
+            });
+            double max_score_sum = 0.0;
+            for (std::size_t i = 0; i < cursor_count; ++i) {
+                max_score_sum += window_scores[order[i]];
+                max_score_sums[i] = max_score_sum;
+            }
+
+            double threshold = get_threshold();
+            std::size_t first_essential = 0;
+            while (first_essential < cursor_count && max_score_sums[first_essential] < threshold) {
+                ++first_essential;
+            }
+
+            int document_id = PostingCursor::END_DOCUMENT_ID;
+            for (std::size_t i = first_essential; i < cursor_count; ++i) {
+                document_id = std::min(document_id, cursors[order[i]].GetDocumentId());
+            }
+            while (document_id <= window_end) {
+                const int slot = findLiveSlot(segment_id, document_id);
+                bool is_candidate = slot != DocumentTable::NO_SLOT && !excluded.IsExcluded(slot)
+                    && document_predicate(document_id, documents_.GetStatus(slot), documents_.GetRating(slot));
+                const double inv_word_count = is_candidate ? 1.0 / documents_.GetWordCount(slot) : 0.0;
+                double score = 0.0;
+                int next_document_id = PostingCursor::END_DOCUMENT_ID;
+                for (std::size_t i = first_essential; i < cursor_count; ++i) {
+                    PostingCursor& cursor = cursors[order[i]];
+                    if (cursor.GetDocumentId() == document_id) {
+                        if (is_candidate) {
+                            term_scores[order[i]] = cursor.GetCount() * inv_word_count * cursor.GetScoreScale();
+                            score += term_scores[order[i]];
+                        }
+                        cursor.Next();
+                    }
+                    next_document_id = std::min(next_document_id, cursor.GetDocumentId());
+                }
+                for (std::size_t i = first_essential; is_candidate && i-- > 0;) {
+                    if (score + max_score_sums[i] < threshold) {
+                        is_candidate = false;
+                        break;
+                    }
+                    PostingCursor& cursor = cursors[order[i]];
+                    cursor.SkipTo(document_id);
+                    if (cursor.GetDocumentId() == document_id) {
+                        term_scores[order[i]] = cursor.GetCount() * inv_word_count * cursor.GetScoreScale();
+                        score += term_scores[order[i]];
+                    }
+                }
+
+                if (is_candidate) {
+                    double relevance = 0.0;
+                    for (double& term_score : term_scores) {
+                        relevance += term_score;
+                        term_score = 0.0;
+                    }
+                    top_documents.Push({ document_id, relevance, documents_.GetRating(slot) });
+                    threshold = get_threshold();
+                }
+                else {
+                    std::fill(term_scores.begin(), term_scores.end(), 0.0);
+                }
+                document_id = next_document_id;
+            }
+
+            for (PostingCursor& cursor : cursors) {
+                if (cursor.GetDocumentId() <= window_end) {
+                    cursor.SkipTo(window_end + 1LL);
+                }
+            }
+        }
+    }
+
+    // Параллельный поиск делит документы на диапазоны id поровну, и каждый диапазон просматривается
+    // последовательным поиском со своим набором лучших. Релевантность документа считает один поток
+    // в порядке слов запроса, а лучшие документы диапазонов сливаются, как результаты шардов, поэтому
+    // результат совпадает с последовательным поиском
+    template <typename ExecutionPolicy, typename DocumentPredicate>
+    void findAllDocuments(ExecutionPolicy&& policy, const Query& query, const std::vector<TermWeight>& weights, DocumentPredicate document_predicate, TopDocuments& top_documents) const {
+        const int document_count = documents_.size();
+        const int range_count = std::max(1, std::min(document_count / MIN_SEARCH_RANGE_SIZE, static_cast<int>(std::thread::hardware_concurrency()) * SEARCH_RANGES_PER_THREAD));
+        std::vector<int> range_bounds(range_count + 1);
+        range_bounds.front() = std::numeric_limits<int>::min();
+        for (int range = 1; range < range_count; ++range) {
+            range_bounds[range] = documents_.GetIdAt(static_cast<int>(static_cast<long long>(document_count) * range / range_count));
+        }
+        range_bounds.back() = PostingCursor::END_DOCUMENT_ID;
+
+        std::vector<int> ranges(range_count);
+        std::iota(ranges.begin(), ranges.end(), 0);
+        std::vector<TopDocuments> range_documents(range_count, top_documents);
+        std::for_each(policy, ranges.begin(), ranges.end(), [&](int range) {
+            findRangeDocuments(query, weights, document_predicate, range_bounds[range], range_bounds[range + 1], range_documents[range]);
+        });
+        for (TopDocuments& documents : range_documents) {
+            for (const Document& document : documents.Extract()) {
+                top_documents.Push(document);
+            }
+        }
+    }
+};
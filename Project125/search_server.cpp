@@ -1,247 +1,450 @@
 #include "search_server.h"
-#include "string_processing.h"
 
-#include <numeric>
-#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
 
-SearchServer::key_iterator SearchServer::begin() {
-	return documents_.begin();
+namespace {
+
+std::string getSnapshotVersionPath(const std::string& snapshot_path, uint64_t version) {
+	return snapshot_path + "." + std::to_string(version);
+}
+
+// Номера снимков snapshot_path.N в каталоге снимка по возрастанию. Недописанные файлы .tmp не подходят
+std::vector<uint64_t> findSnapshotVersions(const std::string& snapshot_path) {
+	const std::filesystem::path path = std::filesystem::absolute(snapshot_path);
+	const std::string prefix = path.filename().string() + ".";
+	std::vector<uint64_t> versions;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(path.parent_path(), error)) {
+		const std::string name = entry.path().filename().string();
+		if (name.size() > prefix.size() && name.compare(0, prefix.size(), prefix) == 0
+			&& std::all_of(name.begin() + prefix.size(), name.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+			versions.push_back(std::stoull(name.substr(prefix.size())));
+		}
+	}
+	std::sort(versions.begin(), versions.end());
+	return versions;
 }
 
-SearchServer::key_iterator SearchServer::end() {
-	return documents_.end();
+// Удаляет снимки старше version и снимок snapshot_path без номера. Отображённый в память файл
+// в Windows удалить нельзя, такой снимок удаляется при следующей контрольной точке или восстановлении
+void removeOldSnapshots(const std::string& snapshot_path, uint64_t version) {
+	std::error_code error;
+	for (const uint64_t old_version : findSnapshotVersions(snapshot_path)) {
+		if (old_version < version) {
+			std::filesystem::remove(getSnapshotVersionPath(snapshot_path, old_version), error);
+		}
+	}
+	std::filesystem::remove(snapshot_path, error);
+}
+
+}
+
+SearchServer::key_const_iterator SearchServer::begin() const {
+	return index_.Read([](const SearchIndex& index) {
+		return index.begin();
+	});
+}
+
+SearchServer::key_const_iterator SearchServer::end() const {
+	return index_.Read([](const SearchIndex& index) {
+		return index.end();
+	});
 }
 
 SearchServer::key_const_iterator SearchServer::cbegin() const {
-	return documents_.cbegin();
+	return begin();
 }
 
 SearchServer::key_const_iterator SearchServer::cend() const {
-	return documents_.cend();
+	return end();
 }
 
-SearchServer::SearchServer(const std::string& stopWordsText) {
+SearchServer::SearchServer(std::string_view stopWordsText) {
 	SetStopWords(stopWordsText);
 }
 
 int SearchServer::GetDocumentId(int index) const {
-	using namespace std::string_literals;
+	return index_.Read([index](const SearchIndex& search_index) {
+		return search_index.GetDocumentId(index);
+	});
+}
 
-	std::vector<int> doc_ids;
-	for (const auto& p : documents_) {
-		doc_ids.push_back(p.first);
-	}
-	if (index > static_cast<int>(doc_ids.size() - 1)) {
-		throw std::out_of_range("index is more than a documents count");
-	}
-	else {
-		return doc_ids.at(index);
+void SearchServer::SetStopWords(std::string_view stopWordsText) {
+	std::lock_guard guard(write_mutex_);
+	index_.Modify([stopWordsText](SearchIndex& index) {
+		index.SetStopWords(stopWordsText);
+	});
+	if (log_) {
+		LogRecord record;
+		record.type = LogRecordType::SET_STOP_WORDS_TEXT;
+		record.text = stopWordsText;
+		log_->Append(record);
 	}
 }
 
-void SearchServer::SetStopWords(const std::string& stopWordsText) {
-	std::set<std::string> temp;
-	split(temp, stopWordsText);
-	SetStopWords(temp);
+void SearchServer::AddDocument(int documentId, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+	std::lock_guard guard(write_mutex_);
+	index_.Modify([&](SearchIndex& index) {
+		index.AddDocument(documentId, document, status, ratings);
+	});
+	if (log_) {
+		LogRecord record;
+		record.type = LogRecordType::ADD_DOCUMENT;
+		record.document_id = documentId;
+		record.status = status;
+		record.ratings = ratings;
+		record.text = document;
+		log_->Append(record);
+	}
+	maintain();
+}
+
+void SearchServer::AddDocuments(const std::vector<NewDocument>& documents) {
+	// Разбор на слова не зависит от индекса и идёт без мьютекса писателя
+	AddPreparedDocuments(documents, SearchIndex::PrepareDocuments(documents));
 }
 
-void SearchServer::AddDocument(int documentId, const std::string& document, DocumentStatus status, const std::vector<int>& ratings) {
-	if (documentId < 0 || documents_.find(documentId) != documents_.end()) {
-		throw std::invalid_argument("Bad document id");
+void SearchServer::AddPreparedDocuments(const std::vector<NewDocument>& documents, std::vector<SearchIndex::PartialIndex> partials) {
+	std::lock_guard guard(write_mutex_);
+	index_.Read([&partials](const SearchIndex& index) {
+		index.CheckDocuments(partials);
+		index.BuildPartialSegments(partials);
+	});
+	index_.Modify([&partials](SearchIndex& index) {
+		index.AddDocuments(partials);
+	});
+	if (log_) {
+		for (const NewDocument& document : documents) {
+			LogRecord record;
+			record.type = LogRecordType::ADD_DOCUMENT;
+			record.document_id = document.id;
+			record.status = document.status;
+			record.ratings = document.ratings;
+			record.text = document.text;
+			log_->Append(record);
+		}
 	}
-	std::vector<std::string> words;
-	if (!splitIntoWordsNoStop(document, words)) {
-		throw std::invalid_argument("Bad document data");
-	};
-	documents_.emplace(documentId, DocumentData{ computeAverageRating(ratings), status, words });
-	document_ids_.insert(documentId);
-	calculateTermFrequency(documentId);
+	maintain();
 }
 
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& rawQuery, DocumentStatus status) const {
-	return FindTopDocuments(rawQuery, [status](int document_id, DocumentStatus document_status, int rating) {
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view rawQuery, DocumentStatus status, int max_count) const {
+	return FindTopDocuments(rawQuery, [status](int, DocumentStatus document_status, int) {
 		return document_status == status;
-	});
+	}, max_count);
 }
 
-std::vector<Document> SearchServer::FindTopDocuments(const std::string& rawQuery) const {
+std::vector<Document> SearchServer::FindTopDocuments(std::string_view rawQuery) const {
 	return FindTopDocuments(rawQuery, DocumentStatus::ACTUAL);
 }
 
-int SearchServer::GetDocumentCount() const {
-	return documents_.size();
+int SearchServer::FindTopDocuments(std::string_view rawQuery, DocumentStatus status, int max_count, Document* output) const {
+	return index_.Read([&](const SearchIndex& index) {
+		return index.FindTopDocuments(rawQuery, [status](int, DocumentStatus document_status, int) {
+			return document_status == status;
+		}, max_count, output);
+	});
 }
 
-void SearchServer::RemoveDocument(int document_id) {
-	bool dc = document_to_word_freqs_.count(document_id);
-	if (!dc) {
-		return;
-	}
-	document_to_word_freqs_.erase(document_id);
-	for (auto& w : word_to_document_freqs_) {
-		if (w.second.count(document_id)) {
-			w.second.erase(document_id);
-		}
-	}
-	if (documents_.count(document_id)) {
-		documents_.erase(document_id);
-	}
-	document_ids_.erase(document_id);
+QueryStatistics SearchServer::GetQueryStatistics(std::string_view rawQuery) const {
+	return index_.Read([rawQuery](const SearchIndex& index) {
+		return index.GetQueryStatistics(rawQuery);
+	});
 }
 
-const std::map<std::string, double>& SearchServer::GetWordFrequencies(int document_id) const {
-	if (document_to_word_freqs_.count(document_id)) {
-		return document_to_word_freqs_.at(document_id);
-	}
-	else {
-		return emptyMap;
-	}
+void SearchServer::Save(const std::string& path) const {
+	index_.Read([&path](const SearchIndex& index) {
+		index.Save(path);
+	});
 }
 
-std::tuple<std::vector<std::string>, DocumentStatus> SearchServer::MatchDocument(const std::string& rawQuery, int documentId) const {
-	Query query;
-	if (!parseQuery(rawQuery, query)) {
-		throw std::invalid_argument("Bad query");
-	}
-	std::vector<std::string> matched_words;
-	for (const std::string& word : query.plus_words) {
-		if (word_to_document_freqs_.count(word) == 0) {
-			continue;
-		}
-		if (word_to_document_freqs_.at(word).count(documentId)) {
-			matched_words.push_back(word);
+void SearchServer::Load(const std::string& path, bool verify_checksums) {
+	{
+		std::lock_guard guard(write_mutex_);
+		if (log_) {
+			throw std::logic_error("Load is not logged, recover the server from a snapshot instead");
 		}
 	}
-	for (const std::string& word : query.minus_words) {
-		if (word_to_document_freqs_.count(word) == 0) {
-			continue;
-		}
-		if (word_to_document_freqs_.at(word).count(documentId)) {
-			matched_words.clear();
-			break;
-		}
-	}
-	return { matched_words, documents_.at(documentId).status };
+	loadFile(IndexFile::Open(path, verify_checksums));
 }
 
-[[nodiscard]]
-bool SearchServer::parseQuery(const std::string& text, Query& query) const {
-	std::vector<std::string> words;
-	split(words, text);
-	for (const std::string& word : words) {
-		QueryWord query_word;
-		if (!parseQueryWord(word, query_word)) {
-			return false;
-		}
-		if (!query_word.is_stop) {
-			if (query_word.is_minus) {
-				query.minus_words.insert(query_word.data);
-			}
-			else {
-				query.plus_words.insert(query_word.data);
-			}
+void SearchServer::Recover(const std::string& snapshot_path, const std::string& log_path, const WriteAheadLogOptions& options) {
+	if (log_) {
+		throw std::logic_error("Write-ahead log is already open");
+	}
+	uint64_t snapshot_sequence = 0;
+	const std::vector<uint64_t> versions = findSnapshotVersions(snapshot_path);
+	const uint64_t snapshot_version = versions.empty() ? 0 : versions.back();
+	const std::string path = versions.empty() ? snapshot_path : getSnapshotVersionPath(snapshot_path, snapshot_version);
+	if (std::filesystem::exists(path)) {
+		const std::shared_ptr<const IndexFile> file = IndexFile::Open(path, false);
+		if (file->HasSection(IndexSection::LOG_SEQUENCE)) {
+			SectionReader in(file->GetSection(IndexSection::LOG_SEQUENCE));
+			snapshot_sequence = in.Read<uint64_t>();
 		}
+		loadFile(file);
+	}
+	// Записи журнала проигрываются обычными изменениями сервера, пока журнал ещё не открыт для записи
+	const uint64_t log_sequence = WriteAheadLog::Replay(log_path, snapshot_sequence, [this](const LogRecord& record) {
+		applyLogRecord(record);
+	});
+	auto log = std::make_unique<WriteAheadLog>(log_path, options, std::max(snapshot_sequence, log_sequence));
+	std::lock_guard guard(write_mutex_);
+	log_ = std::move(log);
+	snapshot_path_ = snapshot_path;
+	snapshot_version_ = snapshot_version;
+	if (snapshot_version > 0) {
+		removeOldSnapshots(snapshot_path_, snapshot_version_);
 	}
-	return true;
 }
 
-[[nodiscard]]
-bool SearchServer::parseQueryWord(std::string text, QueryWord& qw) const {
-	if (text.empty()) {
-		return false;
-	}
-	bool is_minus = false;
-	if (text[0] == '-') {
-		is_minus = true;
-		text = text.substr(1);
-	}
-	if (!isValidWord(text)) {
-		return false;
-	}
-	qw = { text, is_minus, isStopWord(text) };
-	return true;
+void SearchServer::Checkpoint() {
+	std::lock_guard guard(write_mutex_);
+	if (!log_) {
+		throw std::logic_error("Write-ahead log is not open");
+	}
+	// Если сбой случится до очистки журнала, записи до sequence при восстановлении пропускаются
+	const uint64_t sequence = log_->GetLastSequence();
+	// Снимок пишется в новый файл: заменить отображённый в память прежний снимок в Windows нельзя
+	const std::string path = getSnapshotVersionPath(snapshot_path_, snapshot_version_ + 1);
+	index_.Read([&path, sequence](const SearchIndex& index) {
+		index.Save(path, sequence);
+	});
+	++snapshot_version_;
+	log_->Truncate();
+	removeOldSnapshots(snapshot_path_, snapshot_version_);
 }
 
-bool SearchServer::addDocumentData(int document_id, const std::vector<std::string>& words, DocumentStatus status, const std::vector<int>& ratings) {
-	if (documents_.count(document_id) == 0) {
-		documents_.emplace(document_id, DocumentData{ computeAverageRating(ratings), status, words });
-		return true;
+void SearchServer::SyncWriteAheadLog() {
+	if (log_) {
+		log_->Sync();
 	}
-	return false;
 }
 
-int SearchServer::computeAverageRating(const std::vector<int>& ratings) {
-	int ratingsCount = static_cast<int>(ratings.size());
-	if (ratingsCount == 0) {
-		return 0;
-	}
-	else {
-		int rating_sum = std::accumulate(ratings.cbegin(), ratings.cend(), 0);
-		return rating_sum / static_cast<int>(ratings.size());
-	}
+uint64_t SearchServer::GetEpoch() const {
+	return index_.Read([](const SearchIndex& index) {
+		return index.GetEpoch();
+	});
 }
 
-void SearchServer::calculateTermFrequency(int documentId) {
-	const std::vector<std::string>& words = documents_[documentId].words;
-	const double inv_word_count = 1.0 / words.size();
-	for (const std::string& word : words) {
-		if (word_to_document_freqs_[word].count(documentId) == 0) {
-			word_to_document_freqs_[word][documentId] = 0.0;
-			document_to_word_freqs_[documentId][word] = 0.0;
-		}
-		word_to_document_freqs_[word][documentId] += inv_word_count;
-		document_to_word_freqs_[documentId][word] += inv_word_count;
+int SearchServer::GetDocumentCount() const {
+	return index_.Read([](const SearchIndex& index) {
+		return index.GetDocumentCount();
+	});
+}
+
+void SearchServer::RemoveDocument(int document_id) {
+	std::lock_guard guard(write_mutex_);
+	index_.Modify([document_id](SearchIndex& index) {
+		index.RemoveDocument(document_id);
+	});
+	if (log_) {
+		LogRecord record;
+		record.type = LogRecordType::REMOVE_DOCUMENT;
+		record.document_id = document_id;
+		log_->Append(record);
 	}
+	maintain();
 }
 
-bool SearchServer::splitIntoWordsNoStop(const std::string& text, std::vector<std::string>& words) const {
-	std::vector<std::string> tempWords;
-	split(tempWords, text);
-	for (const std::string& word : tempWords) {
-		if (!isValidWord(word)) {
-			return false;
+void SearchServer::RemoveDocuments(const std::vector<int>& document_ids) {
+	std::lock_guard guard(write_mutex_);
+	index_.Modify([&document_ids](SearchIndex& index) {
+		for (const int document_id : document_ids) {
+			index.RemoveDocument(document_id);
 		}
-		if (!isStopWord(word)) {
-			words.push_back(word);
+	});
+	if (log_) {
+		for (const int document_id : document_ids) {
+			LogRecord record;
+			record.type = LogRecordType::REMOVE_DOCUMENT;
+			record.document_id = document_id;
+			log_->Append(record);
 		}
 	}
-	return true;
+	maintain();
 }
 
-bool SearchServer::isValidChar(char character, bool isFirst) {
-	if (character < 0) {
-		return true;
-	}
-	if (iscntrl(character)) {
-		return false;
+void SearchServer::SetRemovalMode(RemovalMode mode, int compaction_threshold) {
+	std::lock_guard guard(write_mutex_);
+	index_.Modify([mode, compaction_threshold](SearchIndex& index) {
+		index.SetRemovalMode(mode, compaction_threshold);
+	});
+	maintain();
+}
+
+void SearchServer::Compact() {
+	std::lock_guard guard(write_mutex_);
+	finishMerge();
+	compact(true);
+}
+
+int SearchServer::GetTombstoneCount() const {
+	return index_.Read([](const SearchIndex& index) {
+		return index.GetTombstoneCount();
+	});
+}
+
+void SearchServer::SetSegmentPolicy(int write_segment_capacity, int merge_factor) {
+	std::lock_guard guard(write_mutex_);
+	index_.Modify([write_segment_capacity, merge_factor](SearchIndex& index) {
+		index.SetSegmentPolicy(write_segment_capacity, merge_factor);
+	});
+	maintain();
+}
+
+void SearchServer::SealWriteSegment() {
+	std::lock_guard guard(write_mutex_);
+	sealWriteSegment();
+	maybeMerge();
+}
+
+void SearchServer::WaitForMerges() {
+	std::lock_guard guard(write_mutex_);
+	finishMerge();
+	const auto pick_segments = [this]() {
+		return index_.Read([](const SearchIndex& index) {
+			return index.PickMergeSegments();
+		});
+	};
+	for (std::vector<int> segments = pick_segments(); !segments.empty(); segments = pick_segments()) {
+		startMerge(std::move(segments));
+		finishMerge();
 	}
-	if (isFirst && isalpha(character)) {
-		return true;
+}
+
+int SearchServer::GetSegmentCount() const {
+	return index_.Read([](const SearchIndex& index) {
+		return index.GetSegmentCount();
+	});
+}
+
+const std::map<TermId, double>& SearchServer::GetWordFrequencies(int document_id) const {
+	return index_.Read([document_id](const SearchIndex& index) -> const std::map<TermId, double>& {
+		return index.GetWordFrequencies(document_id);
+	});
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> SearchServer::MatchDocument(std::string_view rawQuery, int documentId) const {
+	return index_.Read([rawQuery, documentId](const SearchIndex& index) {
+		return index.MatchDocument(rawQuery, documentId);
+	});
+}
+
+void SearchServer::loadFile(std::shared_ptr<const IndexFile> file) {
+	std::lock_guard guard(write_mutex_);
+	finishMerge();
+	index_.Modify([&file](SearchIndex& index) {
+		index.Load(file);
+	});
+}
+
+void SearchServer::applyLogRecord(const LogRecord& record) {
+	switch (record.type) {
+	case LogRecordType::ADD_DOCUMENT:
+		AddDocument(record.document_id, record.text, record.status, record.ratings);
+		break;
+	case LogRecordType::REMOVE_DOCUMENT:
+		RemoveDocument(record.document_id);
+		break;
+	case LogRecordType::SET_STOP_WORDS:
+		SetStopWords(record.stop_words);
+		break;
+	case LogRecordType::SET_STOP_WORDS_TEXT:
+		SetStopWords(record.text);
+		break;
 	}
-	if (!isFirst && isgraph(character)) {
-		return true;
+}
+
+void SearchServer::maintain() {
+	const bool is_full = index_.Read([](const SearchIndex& index) {
+		return index.IsWriteSegmentFull();
+	});
+	if (is_full) {
+		sealWriteSegment();
 	}
-	return false;
+	compact(false);
+	maybeMerge();
 }
 
-bool SearchServer::isValidWord(const std::string& word) {
-	if (word.empty()) {
-		return false;
+void SearchServer::sealWriteSegment() {
+	// Сегмент строится один раз по активной копии: под мьютексом писателя копии совпадают
+	std::shared_ptr<const IndexSegment> sealed = index_.Read([](const SearchIndex& index) {
+		return index.BuildSealedSegment();
+	});
+	index_.Modify([&sealed](SearchIndex& index) {
+		index.InstallSealedSegment(sealed);
+	});
+}
+
+void SearchServer::compact(bool force) {
+	const auto get_segments = [this, force]() {
+		return index_.Read([force](const SearchIndex& index) {
+			return index.GetCompactionSegments(force);
+		});
+	};
+	std::vector<int> segments = get_segments();
+	if (segments.empty()) {
+		return;
 	}
-	for (auto [it, end, i] = its_and_idx(word); it != end; ++it, ++i) {
-		if (!isValidChar(*it, i == 0)) {
-			return false;
+	// Сливаемые сегменты заменятся результатом слияния, поэтому сначала дожидаемся его,
+	// и надгробия переходят к новому сегменту
+	const bool is_merging = index_.Read([&segments](const SearchIndex& index) {
+		return std::any_of(segments.begin(), segments.end(), [&index](int segment) {
+			return index.IsMerging(segment);
+		});
+	});
+	if (is_merging) {
+		finishMerge();
+		segments = get_segments();
+	}
+	std::vector<std::shared_ptr<const IndexSegment>> compacted;
+	index_.Read([&segments, &compacted](const SearchIndex& index) {
+		for (const int segment : segments) {
+			compacted.push_back(index.BuildCompactedSegment(segment));
 		}
+	});
+	index_.Modify([&segments, &compacted](SearchIndex& index) {
+		index.ApplyCompaction(segments, compacted);
+	});
+}
+
+void SearchServer::maybeMerge() {
+	if (merged_segment_.valid()) {
+		if (merged_segment_.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			return;
+		}
+		finishMerge();
+	}
+	std::vector<int> segments = index_.Read([](const SearchIndex& index) {
+		return index.PickMergeSegments();
+	});
+	if (!segments.empty()) {
+		startMerge(std::move(segments));
 	}
-	return true;
 }
 
-bool SearchServer::isStopWord(const std::string& word) const {
-	return m_stopWords.count(word) > 0;
+void SearchServer::startMerge(std::vector<int> segments) {
+	const int id = index_.Modify([&segments](SearchIndex& index) {
+		return index.BeginMerge(segments);
+	});
+	std::vector<IndexSegment::MergeSource> sources = index_.Read([](const SearchIndex& index) {
+		return index.GetMergeSources();
+	});
+	merged_segment_ = std::async(std::launch::async, [id, sources = std::move(sources)]() {
+		return IndexSegment::Merge(id, sources);
+	});
 }
 
-double SearchServer::computeWordInverseDocumentFreq(const std::string& word) const {
-	return log(GetDocumentCount() * 1.0 / word_to_document_freqs_.at(word).size());
+void SearchServer::finishMerge() {
+	if (!merged_segment_.valid()) {
+		return;
+	}
+	std::shared_ptr<const IndexSegment> merged = merged_segment_.get();
+	index_.Modify([&merged](SearchIndex& index) {
+		index.FinishMerge(merged);
+	});
 }
 
 void PrintDocument(const Document& document) {
@@ -252,45 +455,45 @@ void PrintDocument(const Document& document) {
 		<< "rating = "s << document.rating << " }"s << endl;
 }
 
-void PrintMatchDocumentResult(int document_id, const std::vector<std::string>& words, DocumentStatus status) {
+void PrintMatchDocumentResult(int document_id, const std::vector<std::string_view>& words, DocumentStatus status) {
 	using namespace std;
 	cout << "{ "s
 		<< "document_id = "s << document_id << ", "s
 		<< "status = "s << static_cast<int>(status) << ", "s
 		<< "words ="s;
-	for (const string& word : words) {
+	for (const string_view word : words) {
 		cout << ' ' << word;
 	}
 	cout << "}"s << endl;
 }
 
-void AddDocument(SearchServer& search_server, int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings) {
+void AddDocument(SearchServer& search_server, int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
 	using namespace std;
 	try {
 		search_server.AddDocument(document_id, document, status, ratings);
 	}
 	catch (const exception& e) {
-		cout << "   "s << document_id << ": "s << e.what() << endl;
+		cout << "Ошибка добавления документа "s << document_id << ": "s << e.what() << endl;
 	}
 }
 
-void FindTopDocuments(const SearchServer& search_server, const std::string& raw_query) {
+void FindTopDocuments(const SearchServer& search_server, std::string_view raw_query) {
 	using namespace std;
-	cout << "   : "s << raw_query << endl;
+	cout << "Результаты поиска по запросу: "s << raw_query << endl;
 	try {
 		for (const Document& document : search_server.FindTopDocuments(raw_query)) {
 			PrintDocument(document);
 		}
 	}
 	catch (const exception& e) {
-		cout << " : "s << e.what() << endl;
+		cout << "Ошибка поиска: "s << e.what() << endl;
 	}
 }
 
-void MatchDocuments(const SearchServer& search_server, const std::string& query) {
+void MatchDocuments(const SearchServer& search_server, std::string_view query) {
 	using namespace std;
 	try {
-		cout << "   : "s << query << endl;
+		cout << "Матчинг документов по запросу: "s << query << endl;
 		const int document_count = search_server.GetDocumentCount();
 		for (int index = 0; index < document_count; ++index) {
 			const int document_id = search_server.GetDocumentId(index);
@@ -299,6 +502,6 @@ void MatchDocuments(const SearchServer& search_server, const std::string& query)
 		}
 	}
 	catch (const exception& e) {
-		cout << "     "s << query << ": "s << e.what() << endl;
+		cout << "Ошибка матчинга документов на запрос "s << query << ": "s << e.what() << endl;
 	}
 }
\ No newline at end of file
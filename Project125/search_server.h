@@ -1,201 +1,204 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <tuple>
-#include <set>
-#include <algorithm>
 #include <stdexcept>
 #include <map>
-#include <cmath>
+#include <execution>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <type_traits>
 
 #include "document.h"
-#include "string_processing.h"
-#include "utility.h"
-
-const int MAX_RESULT_DOCUMENT_COUNT = 5;
-
+#include "left_right.h"
+#include "search_index.h"
+#include "write_ahead_log.h"
+
+// Поисковый сервер держит две копии индекса (LeftRight): поиск и матчинг идут по активной копии
+// и видят согласованный снимок, даже когда в другом потоке добавляются и удаляются документы.
+// Поиск не берёт блокировок, планы запросов кэшируются в каждом потоке. GetWordFrequencies и MatchDocument
+// при первом обращении к документу из загруженного файла раскодируют его частоты под мьютексом.
+// Изменения выполняются по одному под мьютексом писателя. Словарь, таблица документов и сегмент записи
+// хранятся в двух экземплярах, запечатанные сегменты общие для обеих копий.
+// Ссылки и итераторы из begin(), end() и GetWordFrequencies действительны до следующего изменения,
+// слова из MatchDocument - всё время жизни сервера. Предикат поиска не должен менять сервер
 class SearchServer {
 public:
-    struct DocumentData {
-        int rating;
-        DocumentStatus status;
-        std::vector<std::string> words;
-    };
-
-    typedef std::map<int, DocumentData> DocumentDataMap;
-    typedef DocumentDataMap::iterator DocumentDataMapIterator;
-    typedef DocumentDataMap::const_iterator DocumentDataMapConstIterator;
-
-    class key_iterator : public DocumentDataMapIterator {
-    public:
-        key_iterator() : DocumentDataMapIterator() {};
-        key_iterator(DocumentDataMapIterator s) : DocumentDataMapIterator(s) {};
-        const int* operator->() { return &(DocumentDataMapIterator::operator->()->first); }
-        int operator*() { return DocumentDataMapIterator::operator*().first; }
-    };
-
-    class key_const_iterator : public DocumentDataMapConstIterator {
-    public:
-        key_const_iterator() : DocumentDataMapConstIterator() {};
-        key_const_iterator(DocumentDataMapConstIterator s) : DocumentDataMapConstIterator(s) {};
-        const int* operator->() { return &(DocumentDataMapConstIterator::operator->()->first); }
-        int operator*() { return DocumentDataMapConstIterator::operator*().first; }
-    };
-
-    key_iterator begin();
-    key_iterator end();
+    typedef SearchIndex::key_const_iterator key_const_iterator;
+
+    key_const_iterator begin() const;
+    key_const_iterator end() const;
     key_const_iterator cbegin() const;
     key_const_iterator cend() const;
 
     SearchServer() = default;
 
-    template <typename StringContainer>
+    template <typename StringContainer, typename = std::enable_if_t<!std::is_convertible_v<const StringContainer&, std::string_view>>>
     explicit SearchServer(const StringContainer& stopWords) {
         SetStopWords(stopWords);
     }
 
-    explicit SearchServer(const std::string& stopWordsText);
+    explicit SearchServer(std::string_view stopWordsText);
 
-    template <typename StringContainer>
+    template <typename StringContainer, typename = std::enable_if_t<!std::is_convertible_v<const StringContainer&, std::string_view>>>
     void SetStopWords(const StringContainer& stopWords) {
-        for (const auto& stopWord : stopWords) {
-            if (!isValidWord(stopWord)) {
-                throw std::invalid_argument("Bad stop word");
+        std::lock_guard guard(write_mutex_);
+        index_.Modify([&stopWords](SearchIndex& index) {
+            index.SetStopWords(stopWords);
+        });
+        if (log_) {
+            LogRecord record;
+            record.type = LogRecordType::SET_STOP_WORDS;
+            for (const auto& stopWord : stopWords) {
+                record.stop_words.emplace_back(stopWord);
             }
-            m_stopWords.emplace(stopWord);
+            log_->Append(record);
         }
     }
 
-    void SetStopWords(const std::string& stopWordsText);
+    void SetStopWords(std::string_view stopWordsText);
 
-    void AddDocument(int documentId, const std::string& document, DocumentStatus status, const std::vector<int>& ratings);
+    void AddDocument(int documentId, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+    // Добавляет пакет документов: тексты разбираются на слова параллельно, по части пакета на поток,
+    // и части сливаются в индекс за один проход. Если какой-то документ добавить нельзя, бросает то же исключение,
+    // что AddDocument для первого такого документа, и не добавляет ни одного. Весь пакет попадает в сегмент записи
+    void AddDocuments(const std::vector<NewDocument>& documents);
+    // То же для пакета, уже разобранного SearchIndex::PrepareDocuments: так следующий пакет
+    // разбирается на слова, пока этот добавляется в индекс
+    void AddPreparedDocuments(const std::vector<NewDocument>& documents, std::vector<SearchIndex::PartialIndex> partials);
     void RemoveDocument(int document_id);
+    // Удаляет документы за одно изменение индекса и одну запись в обе копии. Отсутствующие id пропускаются
+    void RemoveDocuments(const std::vector<int>& document_ids);
+
+    void SetRemovalMode(RemovalMode mode, int compaction_threshold = DEFAULT_COMPACTION_THRESHOLD);
+    void Compact();
+    int GetTombstoneCount() const;
+
+    // Сегмент записи запечатывается, когда в нём набирается write_segment_capacity документов.
+    // Сегменты одного яруса размеров сливаются в фоне, как только их набирается merge_factor
+    void SetSegmentPolicy(int write_segment_capacity, int merge_factor = DEFAULT_MERGE_FACTOR);
+    void SealWriteSegment();
+    // Дожидается фонового слияния и сливает сегменты, пока ни в одном ярусе их не останется merge_factor
+    void WaitForMerges();
+    int GetSegmentCount() const;
 
     template <typename DocumentPredicate>
-    std::vector<Document> FindTopDocuments(const std::string& rawQuery, const DocumentPredicate& document_predicate) const {
-        Query query;
-        if (!parseQuery(rawQuery, query)) {
-            throw std::invalid_argument("Bad query");
-        }
-        std::vector<Document> matched_documents = findAllDocuments(query, document_predicate);
+    std::vector<Document> FindTopDocuments(std::string_view rawQuery, const DocumentPredicate& document_predicate, int max_count = MAX_RESULT_DOCUMENT_COUNT) const {
+        return index_.Read([&](const SearchIndex& index) {
+            return index.FindTopDocuments(rawQuery, document_predicate, max_count);
+        });
+    }
+
+    std::vector<Document> FindTopDocuments(std::string_view rawQuery, DocumentStatus status, int max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+    std::vector<Document> FindTopDocuments(std::string_view rawQuery) const;
+    // Записывает до max_count лучших документов в output и возвращает их число. Память под результат
+    // не выделяется, так пакет запросов складывает результаты в один общий буфер
+    int FindTopDocuments(std::string_view rawQuery, DocumentStatus status, int max_count, Document* output) const;
+
+    // Поиск с IDF по внешней статистике корпуса: так шард ранжирует документы как сервер со всем корпусом
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view rawQuery, const QueryStatistics& statistics, const DocumentPredicate& document_predicate, int max_count = MAX_RESULT_DOCUMENT_COUNT) const {
+        return index_.Read([&](const SearchIndex& index) {
+            return index.FindTopDocuments(rawQuery, statistics, document_predicate, max_count);
+        });
+    }
 
-        std::sort(
-            matched_documents.begin(),
-            matched_documents.end(),
-            [](const Document& lhs, const Document& rhs) {
-            return lhs.relevance > rhs.relevance || (abs(lhs.relevance - rhs.relevance) < EPSILON && lhs.rating > rhs.rating);
+    // Число документов и документные частоты плюс-слов запроса
+    QueryStatistics GetQueryStatistics(std::string_view rawQuery) const;
+
+    // Сохраняет индекс в двоичный файл с версией формата и контрольными суммами разделов
+    void Save(const std::string& path) const;
+    // Заменяет содержимое сервера индексом из файла. Файл отображается в память, и поиск читает
+    // списки вхождений прямо с его страниц, поэтому загрузка не зависит от размера списков.
+    // verify_checksums проверяет контрольные суммы всех разделов, для этого файл читается целиком.
+    // Загрузка не пишется в журнал изменений, поэтому при открытом журнале запрещена.
+    // Прежние словарь и файл не освобождаются до разрушения сервера: на них ссылаются слова из MatchDocument
+    void Load(const std::string& path, bool verify_checksums = false);
+
+    // Восстанавливает сервер после сбоя и включает журнал изменений. Загружает последний снимок snapshot_path.N
+    // или снимок snapshot_path без номера, если они есть,
+    // проигрывает записи журнала log_path после снимка, обрезает оборванный хвост журнала и дальше дописывает в него
+    // успешные AddDocument, RemoveDocument и SetStopWords. Вызывается один раз на новом сервере до начала работы.
+    // Настройки удаления и сегментов в журнал не пишутся, их задают до Recover
+    void Recover(const std::string& snapshot_path, const std::string& log_path, const WriteAheadLogOptions& options = {});
+    // Сохраняет снимок и очищает журнал: записи до снимка больше не нужны для восстановления.
+    // Снимок пишется в новый файл snapshot_path.N, прежние снимки удаляются
+    void Checkpoint();
+    // Дожидается записи на диск всех изменений, сделанных до вызова
+    void SyncWriteAheadLog();
+
+    template <typename ExecutionPolicy, typename DocumentPredicate, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view rawQuery, const DocumentPredicate& document_predicate, int max_count = MAX_RESULT_DOCUMENT_COUNT) const {
+        if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+            return FindTopDocuments(rawQuery, document_predicate, max_count);
         }
-        );
-        if (matched_documents.size() > MAX_RESULT_DOCUMENT_COUNT) {
-            matched_documents.resize(MAX_RESULT_DOCUMENT_COUNT);
+        else {
+            return index_.Read([&](const SearchIndex& index) {
+                return index.FindTopDocuments(policy, rawQuery, document_predicate, max_count);
+            });
         }
-        return matched_documents;
     }
 
-    std::vector<Document> FindTopDocuments(const std::string& rawQuery, DocumentStatus status) const;
-    std::vector<Document> FindTopDocuments(const std::string& rawQuery) const;
+    template <typename ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view rawQuery, DocumentStatus status, int max_count = MAX_RESULT_DOCUMENT_COUNT) const {
+        return FindTopDocuments(policy, rawQuery, [status](int, DocumentStatus document_status, int) {
+            return document_status == status;
+        }, max_count);
+    }
 
-    const std::map<std::string, double>& GetWordFrequencies(int document_id) const;
+    template <typename ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::vector<Document> FindTopDocuments(ExecutionPolicy&& policy, std::string_view rawQuery) const {
+        return FindTopDocuments(policy, rawQuery, DocumentStatus::ACTUAL);
+    }
+
+    const std::map<TermId, double>& GetWordFrequencies(int document_id) const;
 
     int GetDocumentCount() const;
     int GetDocumentId(int index) const;
 
-    std::tuple<std::vector<std::string>, DocumentStatus> MatchDocument(const std::string& rawQuery, int documentId) const;
-
-private:
-
-    struct Query {
-        std::set<std::string> plus_words;
-        std::set<std::string> minus_words;
-    };
-
-    struct QueryWord {
-        std::string data;
-        bool is_minus;
-        bool is_stop;
-    };
-
-    std::set<std::string> m_stopWords;
-    std::map<std::string, std::map<int, double>> word_to_document_freqs_;
-    std::map<int, std::map<std::string, double>> document_to_word_freqs_;
-    std::map<int, DocumentData> documents_;
-    std::set<int> document_ids_;
-    std::map<std::string, double> emptyMap;
-
-    [[nodiscard]]
-    bool parseQuery(const std::string& text, Query& query) const;
+    // Счётчик изменений индекса: растёт при каждом добавлении и удалении документа
+    uint64_t GetEpoch() const;
 
-    [[nodiscard]]
-    bool parseQueryWord(std::string text, QueryWord& qw) const;
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view rawQuery, int documentId) const;
 
-    bool addDocumentData(int document_id, const std::vector<std::string>& words, DocumentStatus status, const std::vector<int>& ratings);
-
-    static int computeAverageRating(const std::vector<int>& ratings);
-
-    void calculateTermFrequency(int documentId);
-
-    bool splitIntoWordsNoStop(const std::string& text, std::vector<std::string>& words) const;
-
-    static bool isValidChar(char character, bool isFirst);
-
-    static bool isValidWord(const std::string& word);
-
-    bool isStopWord(const std::string& word) const;
-
-    template<typename Container>
-    static void split(Container& out, const std::string& s, const std::string& delims = " \r\n\t\v") {
-        auto begIdx = s.find_first_not_of(delims);
-        while (begIdx != std::string::npos) {
-            auto endIdx = s.find_first_of(delims, begIdx);
-            if (endIdx == std::string::npos) {
-                endIdx = s.length();
-            }
-            insert_in_container(out, s.substr(begIdx, endIdx - begIdx));
-            begIdx = s.find_first_not_of(delims, endIdx);
-        }
-    }
-
-    template <typename DocumentPredicate>
-    std::vector<Document> findAllDocuments(const Query& query, DocumentPredicate document_predicate) const {
-        std::map<int, double> document_to_relevance;
-        for (const std::string& word : query.plus_words) {
-            if (word_to_document_freqs_.count(word) == 0) {
-                continue;
-            }
-            const double inverse_document_freq = computeWordInverseDocumentFreq(word);
-            for (const auto [document_id, term_freq] : word_to_document_freqs_.at(word)) {
-                const auto& document_data = documents_.at(document_id);
-                if (document_predicate(document_id, document_data.status, document_data.rating)) {
-                    document_to_relevance[document_id] += term_freq * inverse_document_freq;
-                }
-            }
-        }
-
-        for (const std::string& word : query.minus_words) {
-            if (word_to_document_freqs_.count(word) == 0) {
-                continue;
-            }
-            for (const auto [document_id, _] : word_to_document_freqs_.at(word)) {
-                document_to_relevance.erase(document_id);
-            }
+    template <typename ExecutionPolicy, typename = std::enable_if_t<std::is_execution_policy_v<std::decay_t<ExecutionPolicy>>>>
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(ExecutionPolicy&& policy, std::string_view rawQuery, int documentId) const {
+        if constexpr (std::is_same_v<std::decay_t<ExecutionPolicy>, std::execution::sequenced_policy>) {
+            return MatchDocument(rawQuery, documentId);
         }
-
-        std::vector<Document> matched_documents;
-        for (const auto [document_id, relevance] : document_to_relevance) {
-            matched_documents.push_back({
-                document_id,
-                relevance,
-                documents_.at(document_id).rating
+        else {
+            return index_.Read([&](const SearchIndex& index) {
+                return index.MatchDocument(policy, rawQuery, documentId);
             });
         }
-        return matched_documents;
     }
 
-    double computeWordInverseDocumentFreq(const std::string& word) const;
+private:
+    LeftRight<SearchIndex> index_;
+    std::mutex write_mutex_;
+    std::future<std::shared_ptr<const IndexSegment>> merged_segment_;
+    std::unique_ptr<WriteAheadLog> log_;
+    std::string snapshot_path_;
+    // Номер последнего снимка: снимки пишутся в файлы snapshot_path_.N
+    uint64_t snapshot_version_ = 0;
+
+    // Запечатывает полный сегмент записи, убирает надгробия, которые пора убрать, и запускает слияния.
+    // Вызывается под мьютексом писателя после каждого изменения
+    void maintain();
+    void sealWriteSegment();
+    void compact(bool force);
+    void maybeMerge();
+    void startMerge(std::vector<int> segments);
+    void finishMerge();
+    void loadFile(std::shared_ptr<const IndexFile> file);
+    void applyLogRecord(const LogRecord& record);
 };
 
 void PrintDocument(const Document& document);
-void PrintMatchDocumentResult(int document_id, const std::vector<std::string>& words, DocumentStatus status);
-void AddDocument(SearchServer& search_server, int document_id, const std::string& document, DocumentStatus status, const std::vector<int>& ratings);
-void FindTopDocuments(const SearchServer& search_server, const std::string& raw_query);
-void MatchDocuments(const SearchServer& search_server, const std::string& query);
\ No newline at end of file
+void PrintMatchDocumentResult(int document_id, const std::vector<std::string_view>& words, DocumentStatus status);
+void AddDocument(SearchServer& search_server, int document_id, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+void FindTopDocuments(const SearchServer& search_server, std::string_view raw_query);
+void MatchDocuments(const SearchServer& search_server, std::string_view query);
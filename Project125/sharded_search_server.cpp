@@ -0,0 +1,96 @@
+#include "sharded_search_server.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "top_documents.h"
+
+ShardedSearchServer::ShardedSearchServer(int shard_count) {
+    if (shard_count < 1) {
+        throw std::invalid_argument("Bad shard count");
+    }
+    shards_.reserve(shard_count);
+    for (int i = 0; i < shard_count; ++i) {
+        shards_.push_back(std::make_unique<SearchServer>());
+    }
+}
+
+ShardedSearchServer::ShardedSearchServer(std::string_view stopWordsText, int shard_count) : ShardedSearchServer(shard_count) {
+    for (const auto& shard : shards_) {
+        shard->SetStopWords(stopWordsText);
+    }
+}
+
+void ShardedSearchServer::AddDocument(int documentId, std::string_view document, DocumentStatus status, const std::vector<int>& ratings) {
+    if (documentId < 0) {
+        throw std::invalid_argument("Bad document id");
+    }
+    shards_[GetShardIndex(documentId)]->AddDocument(documentId, document, status, ratings);
+}
+
+void ShardedSearchServer::RemoveDocument(int document_id) {
+    if (document_id >= 0) {
+        shards_[GetShardIndex(document_id)]->RemoveDocument(document_id);
+    }
+}
+
+std::vector<Document> ShardedSearchServer::FindTopDocuments(std::string_view rawQuery, DocumentStatus status, int max_count) const {
+    return FindTopDocuments(rawQuery, [status](int, DocumentStatus document_status, int) {
+        return document_status == status;
+    }, max_count);
+}
+
+std::vector<Document> ShardedSearchServer::FindTopDocuments(std::string_view rawQuery) const {
+    return FindTopDocuments(rawQuery, DocumentStatus::ACTUAL);
+}
+
+std::tuple<std::vector<std::string_view>, DocumentStatus> ShardedSearchServer::MatchDocument(std::string_view rawQuery, int documentId) const {
+    if (documentId < 0) {
+        throw std::out_of_range("Bad document id");
+    }
+    return shards_[GetShardIndex(documentId)]->MatchDocument(rawQuery, documentId);
+}
+
+int ShardedSearchServer::GetDocumentCount() const {
+    int count = 0;
+    for (const auto& shard : shards_) {
+        count += shard->GetDocumentCount();
+    }
+    return count;
+}
+
+int ShardedSearchServer::GetShardCount() const {
+    return static_cast<int>(shards_.size());
+}
+
+const SearchServer& ShardedSearchServer::GetShard(int index) const {
+    return *shards_.at(index);
+}
+
+int ShardedSearchServer::GetShardIndex(int document_id) const {
+    // Мультипликативное хеширование: подряд идущие id и id с общим шагом расходятся по всем шардам
+    const uint64_t hash = (static_cast<uint64_t>(static_cast<uint32_t>(document_id)) * 0x9E3779B97F4A7C15ull) >> 32;
+    return static_cast<int>(hash % shards_.size());
+}
+
+int ShardedSearchServer::getHardwareConcurrency() {
+    return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+}
+
+QueryStatistics ShardedSearchServer::getQueryStatistics(std::string_view rawQuery) const {
+    QueryStatistics statistics;
+    for (const auto& shard : shards_) {
+        statistics.Merge(shard->GetQueryStatistics(rawQuery));
+    }
+    return statistics;
+}
+
+std::vector<Document> ShardedSearchServer::mergeTopDocuments(const std::vector<std::vector<Document>>& results, int max_count) {
+    TopDocuments top_documents(max_count);
+    for (const std::vector<Document>& documents : results) {
+        for (const Document& document : documents) {
+            top_documents.Push(document);
+        }
+    }
+    return top_documents.Extract();
+}
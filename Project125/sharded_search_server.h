@@ -0,0 +1,88 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <execution>
+#include <memory>
+#include <numeric>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "document.h"
+#include "search_server.h"
+
+// Сервер, который делит документы между несколькими SearchServer по хешу id. Запрос рассылается
+// всем шардам параллельно (std::execution::par), IDF считается по сумме статистик шардов, поэтому
+// релевантность совпадает с сервером, в котором лежат все документы. Лучшие документы шардов
+// сливаются в общий top-K: каждый документ глобального top-K попадает и в top-K своего шарда
+class ShardedSearchServer {
+public:
+    explicit ShardedSearchServer(int shard_count = getHardwareConcurrency());
+
+    template <typename StringContainer, typename = std::enable_if_t<!std::is_convertible_v<const StringContainer&, std::string_view>>>
+    explicit ShardedSearchServer(const StringContainer& stopWords, int shard_count = getHardwareConcurrency()) : ShardedSearchServer(shard_count) {
+        for (const auto& shard : shards_) {
+            shard->SetStopWords(stopWords);
+        }
+    }
+
+    explicit ShardedSearchServer(std::string_view stopWordsText, int shard_count = getHardwareConcurrency());
+
+    void AddDocument(int documentId, std::string_view document, DocumentStatus status, const std::vector<int>& ratings);
+    void RemoveDocument(int document_id);
+
+    template <typename DocumentPredicate>
+    std::vector<Document> FindTopDocuments(std::string_view rawQuery, const DocumentPredicate& document_predicate, int max_count = MAX_RESULT_DOCUMENT_COUNT) const {
+        const QueryStatistics statistics = getQueryStatistics(rawQuery);
+        std::vector<std::vector<Document>> results(shards_.size());
+        forEachShard([&](std::size_t index) {
+            results[index] = shards_[index]->FindTopDocuments(rawQuery, statistics, document_predicate, max_count);
+        });
+        return mergeTopDocuments(results, max_count);
+    }
+
+    std::vector<Document> FindTopDocuments(std::string_view rawQuery, DocumentStatus status, int max_count = MAX_RESULT_DOCUMENT_COUNT) const;
+    std::vector<Document> FindTopDocuments(std::string_view rawQuery) const;
+
+    // Документ лежит ровно в одном шарде, поэтому матчинг выполняет только он
+    std::tuple<std::vector<std::string_view>, DocumentStatus> MatchDocument(std::string_view rawQuery, int documentId) const;
+
+    int GetDocumentCount() const;
+    int GetShardCount() const;
+    const SearchServer& GetShard(int index) const;
+    int GetShardIndex(int document_id) const;
+
+private:
+    std::vector<std::unique_ptr<SearchServer>> shards_;
+
+    static int getHardwareConcurrency();
+
+    QueryStatistics getQueryStatistics(std::string_view rawQuery) const;
+
+    static std::vector<Document> mergeTopDocuments(const std::vector<std::vector<Document>>& results, int max_count);
+
+    // Вызывает function для каждого шарда параллельно и пробрасывает первое исключение
+    template <typename Function>
+    void forEachShard(Function function) const {
+        std::vector<std::size_t> indexes(shards_.size());
+        std::iota(indexes.begin(), indexes.end(), 0);
+        std::vector<std::exception_ptr> errors(shards_.size());
+        std::for_each(std::execution::par, indexes.begin(), indexes.end(), [&](std::size_t index) {
+            try {
+                function(index);
+            }
+            catch (...) {
+                errors[index] = std::current_exception();
+            }
+        });
+        for (const std::exception_ptr& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+};
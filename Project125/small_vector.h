@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Вектор, первые N элементов которого лежат во встроенном буфере. Пока элементов не больше N,
+// память в куче не выделяется. Рассчитан на тривиально копируемые типы
+template <typename T, std::size_t N>
+class SmallVector {
+    static_assert(std::is_trivially_copyable_v<T>, "SmallVector stores trivially copyable types only");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    iterator begin() {
+        return data();
+    }
+
+    iterator end() {
+        return data() + size_;
+    }
+
+    const_iterator begin() const {
+        return data();
+    }
+
+    const_iterator end() const {
+        return data() + size_;
+    }
+
+    std::size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    T& operator[](std::size_t index) {
+        return data()[index];
+    }
+
+    const T& operator[](std::size_t index) const {
+        return data()[index];
+    }
+
+    void push_back(const T& value) {
+        if (size_ < N) {
+            inline_[size_] = value;
+        }
+        else {
+            if (size_ == N) {
+                heap_.assign(inline_.begin(), inline_.end());
+            }
+            heap_.push_back(value);
+        }
+        ++size_;
+    }
+
+    // Уменьшает размер, например после std::unique
+    void erase(const_iterator first, const_iterator last) {
+        T* out = begin() + (first - begin());
+        for (const T* it = last; it != end(); ++it) {
+            *out++ = *it;
+        }
+        const std::size_t new_size = out - begin();
+        if (size_ > N) {
+            if (new_size <= N) {
+                std::copy(heap_.begin(), heap_.begin() + new_size, inline_.begin());
+                heap_.clear();
+            }
+            else {
+                heap_.resize(new_size);
+            }
+        }
+        size_ = new_size;
+    }
+
+    void clear() {
+        heap_.clear();
+        size_ = 0;
+    }
+
+private:
+    std::array<T, N> inline_{};
+    std::vector<T> heap_;
+    std::size_t size_ = 0;
+
+    T* data() {
+        return size_ > N ? heap_.data() : inline_.data();
+    }
+
+    const T* data() const {
+        return size_ > N ? heap_.data() : inline_.data();
+    }
+};
\ No newline at end of file
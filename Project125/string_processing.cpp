@@ -1,22 +1,195 @@
 #include "string_processing.h"
 
-std::vector<std::string> SplitIntoWords(const std::string& text) {
-    std::vector<std::string> words;
-    std::string word;
-    for (const char c : text) {
-        if (c == ' ') {
-            if (!word.empty()) {
-                words.push_back(word);
-                word.clear();
-            }
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SEARCH_SERVER_SSE2
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Текст разбирается блоками по 32 байта. Для блока строятся битовые маски: бит i соответствует байту i
+const std::size_t BLOCK_SIZE = 32;
+
+struct BlockMasks {
+    // Пробел, \t, \n, \v и \r
+    uint32_t delimiters;
+    // Управляющие символы, включая разделители
+    uint32_t controls;
+    // Символы, с которых может начинаться слово: латинские буквы и байты больше 127
+    uint32_t letters;
+};
+
+enum CharClass : uint8_t {
+    DELIMITER = 1,
+    CONTROL = 2,
+    LETTER = 4,
+};
+
+// Классы символов в локали "C", как у isspace, iscntrl и isalpha
+const std::array<uint8_t, 256> CHAR_CLASSES = []() {
+    std::array<uint8_t, 256> classes{};
+    for (int c = 0; c < 256; ++c) {
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\r') {
+            classes[c] |= DELIMITER;
+        }
+        if (c < 32 || c == 127) {
+            classes[c] |= CONTROL;
+        }
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 128) {
+            classes[c] |= LETTER;
+        }
+    }
+    return classes;
+}();
+
+#if defined(__AVX2__)
+
+BlockMasks classifyBlock(const char* data) {
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    const auto equal = [&bytes](char c) {
+        return _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c));
+    };
+    const __m256i delimiters = _mm256_or_si256(_mm256_or_si256(equal(' '), equal('\t')), _mm256_or_si256(_mm256_or_si256(equal('\n'), equal('\v')), equal('\r')));
+    // Сравнения знаковые: байты больше 127 отрицательны и отсекаются проверкой на неотрицательность
+    const __m256i is_ascii = _mm256_cmpgt_epi8(bytes, _mm256_set1_epi8(-1));
+    const __m256i controls = _mm256_or_si256(_mm256_and_si256(is_ascii, _mm256_cmpgt_epi8(_mm256_set1_epi8(32), bytes)), equal(127));
+    const __m256i lower = _mm256_or_si256(bytes, _mm256_set1_epi8(0x20));
+    const __m256i letters = _mm256_or_si256(_mm256_andnot_si256(is_ascii, _mm256_set1_epi8(-1)),
+        _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), lower)));
+    return {
+        static_cast<uint32_t>(_mm256_movemask_epi8(delimiters)),
+        static_cast<uint32_t>(_mm256_movemask_epi8(controls)),
+        static_cast<uint32_t>(_mm256_movemask_epi8(letters)),
+    };
+}
+
+#elif defined(SEARCH_SERVER_SSE2)
+
+BlockMasks classifyHalf(const char* data) {
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const auto equal = [&bytes](char c) {
+        return _mm_cmpeq_epi8(bytes, _mm_set1_epi8(c));
+    };
+    const __m128i delimiters = _mm_or_si128(_mm_or_si128(equal(' '), equal('\t')), _mm_or_si128(_mm_or_si128(equal('\n'), equal('\v')), equal('\r')));
+    // Сравнения знаковые: байты больше 127 отрицательны и отсекаются проверкой на неотрицательность
+    const __m128i is_ascii = _mm_cmpgt_epi8(bytes, _mm_set1_epi8(-1));
+    const __m128i controls = _mm_or_si128(_mm_and_si128(is_ascii, _mm_cmplt_epi8(bytes, _mm_set1_epi8(32))), equal(127));
+    const __m128i lower = _mm_or_si128(bytes, _mm_set1_epi8(0x20));
+    const __m128i letters = _mm_or_si128(_mm_cmplt_epi8(bytes, _mm_setzero_si128()),
+        _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1))));
+    return {
+        static_cast<uint32_t>(_mm_movemask_epi8(delimiters)),
+        static_cast<uint32_t>(_mm_movemask_epi8(controls)),
+        static_cast<uint32_t>(_mm_movemask_epi8(letters)),
+    };
+}
+
+BlockMasks classifyBlock(const char* data) {
+    const BlockMasks low = classifyHalf(data);
+    const BlockMasks high = classifyHalf(data + 16);
+    return { low.delimiters | high.delimiters << 16, low.controls | high.controls << 16, low.letters | high.letters << 16 };
+}
+
+#else
+
+BlockMasks classifyBlock(const char* data) {
+    BlockMasks masks{ 0, 0, 0 };
+    for (std::size_t i = 0; i < BLOCK_SIZE; ++i) {
+        const uint8_t classes = CHAR_CLASSES[static_cast<uint8_t>(data[i])];
+        masks.delimiters |= static_cast<uint32_t>(classes & DELIMITER) << i;
+        masks.controls |= static_cast<uint32_t>((classes & CONTROL) >> 1) << i;
+        masks.letters |= static_cast<uint32_t>((classes & LETTER) >> 2) << i;
+    }
+    return masks;
+}
+
+#endif
+
+int countTrailingZeros(uint32_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+// Один проход по тексту: границы слов находятся по смене бита в маске разделителей,
+// неверные символы - по маскам того же блока, поэтому каждый байт читается один раз
+template <bool Validate>
+bool splitIntoWords(std::string_view text, std::vector<std::string_view>& words) {
+    const char* data = text.data();
+    // Перед текстом как будто стоит разделитель
+    uint32_t previous_delimiter = 1;
+    std::size_t word_begin = 0;
+    for (std::size_t base = 0; base < text.size(); base += BLOCK_SIZE) {
+        BlockMasks masks;
+        if (text.size() - base >= BLOCK_SIZE) {
+            masks = classifyBlock(data + base);
         }
         else {
-            word += c;
+            // Хвост дополняется пробелами, и последнее слово заканчивается внутри блока
+            char block[BLOCK_SIZE];
+            std::memset(block, ' ', BLOCK_SIZE);
+            std::memcpy(block, data + base, text.size() - base);
+            masks = classifyBlock(block);
+        }
+        const uint32_t shifted_delimiters = masks.delimiters << 1 | previous_delimiter;
+        if constexpr (Validate) {
+            const uint32_t word_starts = ~masks.delimiters & shifted_delimiters;
+            if (((masks.controls & ~masks.delimiters) | (word_starts & ~masks.letters)) != 0) {
+                return false;
+            }
         }
+        for (uint32_t changes = masks.delimiters ^ shifted_delimiters; changes != 0; changes &= changes - 1) {
+            const int bit = countTrailingZeros(changes);
+            const std::size_t position = base + bit;
+            if (masks.delimiters >> bit & 1) {
+                words.push_back(text.substr(word_begin, position - word_begin));
+            }
+            else {
+                word_begin = position;
+            }
+        }
+        previous_delimiter = masks.delimiters >> (BLOCK_SIZE - 1);
     }
-    if (!word.empty()) {
-        words.push_back(word);
+    if (previous_delimiter == 0) {
+        words.push_back(text.substr(word_begin));
     }
+    return true;
+}
 
+}
+
+std::vector<std::string_view> SplitIntoWords(std::string_view text) {
+    std::vector<std::string_view> words;
+    splitIntoWords<false>(text, words);
     return words;
-}
\ No newline at end of file
+}
+
+bool SplitIntoValidWords(std::string_view text, std::vector<std::string_view>& words) {
+    return splitIntoWords<true>(text, words);
+}
+
+bool IsValidWord(std::string_view word) {
+    if (word.empty() || (CHAR_CLASSES[static_cast<uint8_t>(word[0])] & LETTER) == 0) {
+        return false;
+    }
+    for (const char c : word) {
+        if ((CHAR_CLASSES[static_cast<uint8_t>(c)] & (CONTROL | DELIMITER)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -1,17 +1,24 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <set>
 
-std::vector<std::string> SplitIntoWords(const std::string& text);
+// Слова текста, разделённые пробелами и символами \t, \n, \v и \r
+std::vector<std::string_view> SplitIntoWords(std::string_view text);
+// Разбивает текст на слова, как SplitIntoWords, и за тот же проход проверяет их (см. IsValidWord).
+// Слова дописываются в words. Если хоть одно слово неверно, возвращает false, и содержимое words не определено
+bool SplitIntoValidWords(std::string_view text, std::vector<std::string_view>& words);
+// Слово непустое, начинается с латинской буквы или байта больше 127 и не содержит пробельных и управляющих символов
+bool IsValidWord(std::string_view word);
 
 template <typename StringContainer>
-std::set<std::string> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
-    std::set<std::string> non_empty_strings;
-    for (const std::string& str : strings) {
+std::set<std::string, std::less<>> MakeUniqueNonEmptyStrings(const StringContainer& strings) {
+    std::set<std::string, std::less<>> non_empty_strings;
+    for (const std::string_view str : strings) {
         if (!str.empty()) {
-            non_empty_strings.insert(str);
+            non_empty_strings.emplace(str);
         }
     }
     return non_empty_strings;
@@ -0,0 +1,170 @@
+#include "term_dictionary.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "index_file.h"
+
+namespace {
+
+const std::size_t MIN_SLOT_COUNT = 16;
+
+}
+
+TermId TermDictionary::Intern(std::string_view word) {
+    const uint64_t hash = hashWord(word);
+    const TermId found = find(word, hash);
+    if (found != INVALID_TERM_ID) {
+        return found;
+    }
+    const TermId term = static_cast<TermId>(mapped_count_ + terms_.size());
+    terms_.emplace_back(word);
+    if (terms_.size() * 2 > slots_.size()) {
+        // Таблица растёт вдвое, хеши слов вычисляются заново: в ячейке хранится только их старшая половина
+        std::vector<Slot> slots(std::max(MIN_SLOT_COUNT, slots_.size() * 2), Slot{ 0, INVALID_TERM_ID });
+        for (std::size_t i = 0; i + 1 < terms_.size(); ++i) {
+            insertSlot(slots, hashWord(terms_[i]), static_cast<TermId>(mapped_count_ + i));
+        }
+        slots_ = std::move(slots);
+    }
+    insertSlot(slots_, hash, term);
+    return term;
+}
+
+TermId TermDictionary::Find(std::string_view word) const {
+    return find(word, hashWord(word));
+}
+
+std::string_view TermDictionary::GetTerm(TermId term) const {
+    if (term >= 0 && term < mapped_count_) {
+        return std::string_view(mapped_chars_ + mapped_offsets_[term], mapped_offsets_[term + 1] - mapped_offsets_[term]);
+    }
+    return terms_.at(term - mapped_count_);
+}
+
+int TermDictionary::GetTermCount() const {
+    return static_cast<int>(mapped_count_ + terms_.size());
+}
+
+void TermDictionary::Save(SectionWriter& out) const {
+    static_assert(std::is_trivially_copyable_v<Slot> && sizeof(Slot) == 8, "Slot is stored in index files as is");
+    const int term_count = GetTermCount();
+    std::vector<uint64_t> offsets(term_count + 1, 0);
+    std::string chars;
+    // Таблица файла заполнена не больше чем наполовину, как и таблица в памяти
+    std::size_t slot_count = 1;
+    while (slot_count < 2 * static_cast<std::size_t>(term_count)) {
+        slot_count *= 2;
+    }
+    std::vector<Slot> slots(slot_count, Slot{ 0, INVALID_TERM_ID });
+    for (TermId term = 0; term < term_count; ++term) {
+        const std::string_view word = GetTerm(term);
+        chars += word;
+        offsets[term + 1] = chars.size();
+        insertSlot(slots, hashWord(word), term);
+    }
+    out.Write<uint64_t>(term_count);
+    out.Write<uint64_t>(chars.size());
+    out.Write<uint64_t>(slots.size());
+    out.WriteArray(offsets.data(), offsets.size());
+    out.WriteArray(slots.data(), slots.size());
+    out.WriteArray(chars.data(), chars.size());
+}
+
+void TermDictionary::Map(SectionReader& in) {
+    const uint64_t term_count = in.Read<uint64_t>();
+    const uint64_t char_count = in.Read<uint64_t>();
+    const uint64_t slot_count = in.Read<uint64_t>();
+    if (term_count >= static_cast<uint64_t>(std::numeric_limits<TermId>::max())) {
+        throw std::runtime_error("Bad index file: too many terms");
+    }
+    if (slot_count <= term_count || (slot_count & (slot_count - 1)) != 0) {
+        throw std::runtime_error("Bad index file: bad dictionary table");
+    }
+    terms_.clear();
+    slots_.clear();
+    mapped_offsets_ = in.ReadArray<uint64_t>(term_count + 1);
+    mapped_slots_ = in.ReadArray<Slot>(slot_count);
+    mapped_chars_ = in.ReadArray<char>(char_count);
+    mapped_slot_count_ = slot_count;
+    mapped_count_ = static_cast<int>(term_count);
+    if (mapped_offsets_[term_count] != char_count) {
+        throw std::runtime_error("Bad index file: dictionary is truncated");
+    }
+    // Смещения слов проверяются при каждой загрузке, а не только с проверкой контрольных сумм:
+    // иначе GetTerm повреждённого файла читал бы за пределами раздела
+    for (uint64_t i = 0; i < term_count; ++i) {
+        if (mapped_offsets_[i] > mapped_offsets_[i + 1]) {
+            throw std::runtime_error("Bad index file: bad dictionary offsets");
+        }
+    }
+    // В таблице должна быть пустая ячейка, иначе поиск отсутствующего слова не остановится
+    uint64_t used_slots = 0;
+    for (uint64_t i = 0; i < slot_count; ++i) {
+        const TermId term = mapped_slots_[i].term;
+        if (term != INVALID_TERM_ID && (term < 0 || static_cast<uint64_t>(term) >= term_count)) {
+            throw std::runtime_error("Bad index file: bad dictionary table");
+        }
+        used_slots += term != INVALID_TERM_ID;
+    }
+    if (used_slots >= slot_count) {
+        throw std::runtime_error("Bad index file: bad dictionary table");
+    }
+}
+
+// Хеш входит в формат файла индекса, поэтому он свой, а не std::hash: слово читается по 8 байт,
+// каждый кусок перемешивается умножением, в конце биты перемешиваются финализатором splitmix64
+uint64_t TermDictionary::hashWord(std::string_view word) {
+    uint64_t hash = 0x9E3779B97F4A7C15ull ^ word.size();
+    const auto mix = [&hash](uint64_t chunk) {
+        hash = (hash ^ chunk) * 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 31;
+    };
+    std::size_t position = 0;
+    for (; position + sizeof(uint64_t) <= word.size(); position += sizeof(uint64_t)) {
+        uint64_t chunk;
+        std::memcpy(&chunk, word.data() + position, sizeof(chunk));
+        mix(chunk);
+    }
+    if (position < word.size()) {
+        uint64_t chunk = 0;
+        std::memcpy(&chunk, word.data() + position, word.size() - position);
+        mix(chunk);
+    }
+    hash ^= hash >> 30;
+    hash *= 0x94D049BB133111EBull;
+    return hash ^ (hash >> 31);
+}
+
+TermId TermDictionary::find(std::string_view word, uint64_t hash) const {
+    const TermId mapped = findInSlots(mapped_slots_, mapped_slot_count_, word, hash);
+    return mapped != INVALID_TERM_ID ? mapped : findInSlots(slots_.data(), slots_.size(), word, hash);
+}
+
+// Линейное пробирование от ячейки по младшим битам хеша до пустой ячейки
+TermId TermDictionary::findInSlots(const Slot* slots, std::size_t slot_count, std::string_view word, uint64_t hash) const {
+    if (slot_count == 0) {
+        return INVALID_TERM_ID;
+    }
+    const uint32_t stored_hash = static_cast<uint32_t>(hash >> 32);
+    for (std::size_t i = hash & (slot_count - 1);; i = (i + 1) & (slot_count - 1)) {
+        const Slot& slot = slots[i];
+        if (slot.term == INVALID_TERM_ID) {
+            return INVALID_TERM_ID;
+        }
+        if (slot.hash == stored_hash && GetTerm(slot.term) == word) {
+            return slot.term;
+        }
+    }
+}
+
+void TermDictionary::insertSlot(std::vector<Slot>& slots, uint64_t hash, TermId term) {
+    std::size_t i = hash & (slots.size() - 1);
+    while (slots[i].term != INVALID_TERM_ID) {
+        i = (i + 1) & (slots.size() - 1);
+    }
+    slots[i] = { static_cast<uint32_t>(hash >> 32), term };
+}
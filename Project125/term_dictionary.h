@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class SectionReader;
+class SectionWriter;
+
+using TermId = int;
+
+const TermId INVALID_TERM_ID = -1;
+
+// Словарь слов. Слова ищутся в хеш-таблице с открытой адресацией: ячейка хранит 32 бита хеша слова и его id,
+// поэтому поиск читает соседние ячейки одного массива и сравнивает строки только при совпадении хеша.
+// Слова из файла индекса и их таблица читаются прямо из отображённой памяти. Новые слова хранятся в памяти
+class TermDictionary {
+public:
+    TermId Intern(std::string_view word);
+    TermId Find(std::string_view word) const;
+
+    std::string_view GetTerm(TermId term) const;
+    int GetTermCount() const;
+
+    void Save(SectionWriter& out) const;
+    // Память раздела должна жить, пока используется словарь
+    void Map(SectionReader& in);
+
+private:
+    // Пустая ячейка - с INVALID_TERM_ID
+    struct Slot {
+        uint32_t hash;
+        TermId term;
+    };
+
+    std::deque<std::string> terms_;
+    // Таблица новых слов, размер - степень двойки, заполнена не больше чем наполовину
+    std::vector<Slot> slots_;
+
+    int mapped_count_ = 0;
+    const uint64_t* mapped_offsets_ = nullptr;
+    const Slot* mapped_slots_ = nullptr;
+    std::size_t mapped_slot_count_ = 0;
+    const char* mapped_chars_ = nullptr;
+
+    static uint64_t hashWord(std::string_view word);
+    TermId find(std::string_view word, uint64_t hash) const;
+    TermId findInSlots(const Slot* slots, std::size_t slot_count, std::string_view word, uint64_t hash) const;
+    static void insertSlot(std::vector<Slot>& slots, uint64_t hash, TermId term);
+};
@@ -1,13 +1,47 @@
 #include "tests.h"
 
+#include <array>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <numeric>
 #include <functional>
-
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <execution>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include "corpus_ingestion.h"
+#include "corpus_statistics.h"
+#include "document_table.h"
+#include "frequency_sketch.h"
+#include "index_segment.h"
+#include "posting_list.h"
+#include "process_queries.h"
+#include "remove_duplicates.h"
+#include "request_queue.h"
+#include "result_cache.h"
+#include "score_accumulator.h"
 #include "search_server.h"
-
-//  ,     -   
+#include "sharded_search_server.h"
+#include "small_vector.h"
+#include "string_processing.h"
+#include "term_dictionary.h"
+#include "top_documents.h"
+#include "write_ahead_log.h"
+
+// Тест проверяет, что поисковая система исключает стоп-слова при добавлении документов
 void TestExcludeStopWordsFromAddedDocumentContent() {
     using namespace std;
 
@@ -15,8 +49,8 @@ void TestExcludeStopWordsFromAddedDocumentContent() {
     const string content = "cat in the city"s;
     const vector<int> ratings = { 1, 2, 3 };
 
-    //  ,   ,     -,
-    //   
+    // Сначала убеждаемся, что поиск слова, не входящего в список стоп-слов,
+    // находит нужный документ
     {
         SearchServer server;
         server.AddDocument(doc_id, content, DocumentStatus::ACTUAL, ratings);
@@ -26,8 +60,8 @@ void TestExcludeStopWordsFromAddedDocumentContent() {
         ASSERT_EQUAL(doc0.id, doc_id);
     }
 
-    //  ,     ,    -,
-    //   
+    // Затем убеждаемся, что поиск этого же слова, входящего в список стоп-слов,
+    // возвращает пустой результат
     {
         SearchServer server;
         server.SetStopWords("in the"s);
@@ -36,7 +70,7 @@ void TestExcludeStopWordsFromAddedDocumentContent() {
     }
 }
 
-//  ,  .       ,     .
+// Тест проверяет, добавление документов. Добавленный документ должен находиться по поисковому запросу, который содержит слова из документа.
 void TestAddDocument() {
     using namespace std;
 
@@ -97,7 +131,7 @@ void TestAddDocument() {
     }
 }
 
-//  ,  -. -    .
+// Тест проверяет, поддержку стоп-слов. Стоп-слова исключаются из текста документов.
 void TestExcludeStopWords() {
     using namespace std;
 
@@ -118,7 +152,7 @@ void TestExcludeStopWords() {
     }
 }
 
-//  ,  -. ,  -  ,      .
+// Тест проверяет, поддержку минус-слов. Документы, содержащие минус-слова поискового запроса, не должны включаться в результаты поиска.
 void TestMinusWords() {
     using namespace std;
 
@@ -157,9 +191,9 @@ void TestMinusWords() {
     }
 }
 
-//  ,  .        
-//      ,   .   
-//     -,     .
+// Тест проверяет, матчинг документов. При матчинге документа по поисковому запросу должны быть
+// возвращены все слова из поискового запроса, присутствующие в документе. Если есть соответствие
+// хотя бы по одному минус-слову, должен возвращаться пустой список слов.
 void TestMatch() {
     using namespace std;
 
@@ -210,8 +244,8 @@ void TestMatch() {
     }
 }
 
-//  ,     .   
-//         .
+// Тест проверяет, сортировку найденных документов по релевантности. Возвращаемые при поиске
+// документов результаты должны быть отсортированы в порядке убывания релевантности.
 void TestRelevanceSort() {
     using namespace std;
 
@@ -251,8 +285,8 @@ void TestRelevanceSort() {
     }
 }
 
-//  ,   .  
-//      .
+// Тест проверяет, вычисление рейтинга документов. Рейтинг добавленного
+// документа равен среднему арифметическому оценок документа.
 void TestRating() {
     using namespace std;
 
@@ -307,7 +341,7 @@ void TestRating() {
     }
 }
 
-//  ,      ,  .
+// Тест проверяет, фильтрацию результатов поиска с использованием предиката, задаваемого пользователем.
 void TestLambdaFiltering() {
     using namespace std;
 
@@ -341,7 +375,7 @@ void TestLambdaFiltering() {
     }
 }
 
-//  ,  ,   .
+// Тест проверяет, поиск документов, имеющих заданный статус.
 void TestFilteringStatus() {
     using namespace std;
 
@@ -393,7 +427,7 @@ void TestFilteringStatus() {
     }
 }
 
-//  ,     .
+// Тест проверяет, корректное вычисление релевантности найденных документов.
 void TestRelevance() {
     using namespace std;
 
@@ -684,7 +718,1871 @@ void TestRelevance() {
     }
 }
 
-//  TestSearchServer      
+// Тест проверяет, словарь терминов. Одно и то же слово всегда получает один и тот же идентификатор, а незнакомые слова запроса ничего не находят.
+void TestTermDictionary() {
+    using namespace std;
+
+    {
+        TermDictionary dictionary;
+        const TermId cat = dictionary.Intern("cat"s);
+        const TermId city = dictionary.Intern("city"s);
+        ASSERT(cat != city);
+        ASSERT_EQUAL(dictionary.Intern("cat"s), cat);
+        ASSERT_EQUAL(dictionary.Find("city"s), city);
+        ASSERT_EQUAL(dictionary.Find("dog"s), INVALID_TERM_ID);
+        ASSERT_EQUAL(dictionary.GetTerm(cat), "cat"s);
+        ASSERT_EQUAL(dictionary.GetTermCount(), 2);
+    }
+
+    {
+        SearchServer server("in the"s);
+        server.AddDocument(1, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(2, "dog in the city"s, DocumentStatus::ACTUAL, { 2 });
+        ASSERT(server.FindTopDocuments("starling"s).empty());
+        ASSERT(server.FindTopDocuments("the"s).empty());
+        ASSERT_EQUAL(server.FindTopDocuments("city -starling"s).size(), 2u);
+        ASSERT_EQUAL(server.GetWordFrequencies(1).size(), 2u);
+        ASSERT_EQUAL(server.GetWordFrequencies(3).size(), 0u);
+    }
+
+    // Таблица слов растёт, и каждое слово находит свой id. Слова различаются и в первых 8 байтах, и только в хвосте
+    {
+        TermDictionary dictionary;
+        vector<string> words;
+        for (int i = 0; i < 5000; ++i) {
+            words.push_back(i % 2 == 0 ? "w"s + to_string(i) : "long-common-prefix-"s + to_string(i));
+            ASSERT_EQUAL(dictionary.Intern(words.back()), i);
+        }
+        for (int i = 0; i < 5000; ++i) {
+            ASSERT_EQUAL(dictionary.Find(words[i]), i);
+            ASSERT_EQUAL(dictionary.GetTerm(i), words[i]);
+        }
+        ASSERT_EQUAL(dictionary.Find("long-common-prefix-5000"s), INVALID_TERM_ID);
+        ASSERT_EQUAL(dictionary.Find(""s), INVALID_TERM_ID);
+    }
+
+    // Стоп-слова можно задать таблицей, собранной при компиляции. После загрузки из файла
+    // словарь ищет и слова файла, и новые слова
+    {
+        static constexpr array<string_view, 3> stop_words = { "in"sv, "the"sv, "with"sv };
+        SearchServer server(stop_words);
+        server.AddDocument(1, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+        const string path = (filesystem::temp_directory_path() / "search_server_dictionary_test.index"s).string();
+        server.Save(path);
+        SearchServer loaded;
+        loaded.Load(path);
+        loaded.AddDocument(2, "dog with the cat"s, DocumentStatus::ACTUAL, { 2 });
+        loaded.AddDocument(3, "starling in a city"s, DocumentStatus::ACTUAL, { 3 });
+        ASSERT(loaded.FindTopDocuments("the with in"s).empty());
+        ASSERT_EQUAL(loaded.FindTopDocuments("cat"s).size(), 2u);
+        ASSERT_EQUAL(loaded.FindTopDocuments("starling"s).size(), 1u);
+        ASSERT_EQUAL(loaded.GetWordFrequencies(2).size(), 2u);
+        ASSERT_EQUAL(loaded.GetWordFrequencies(3).size(), 3u);
+        filesystem::remove(path);
+    }
+}
+
+// Тест проверяет, сжатый список вхождений. Вставка в произвольном порядке и удаление сохраняют отсортированный по id список с правильными частотами.
+void TestPostingList() {
+    using namespace std;
+
+    PostingList postings;
+    map<int, int> expected;
+    for (int i = 0; i < 1000; ++i) {
+        const int document_id = (i * 7919) % 1000 * 3;
+        postings.Insert(document_id, i % 5 + 1);
+        expected[document_id] = i % 5 + 1;
+    }
+    postings.Insert(4000, 2);
+    expected[4000] = 2;
+    for (int document_id = 0; document_id < 3000; document_id += 6) {
+        ASSERT(postings.Erase(document_id));
+        expected.erase(document_id);
+    }
+    ASSERT(!postings.Erase(1));
+    ASSERT(!postings.Erase(5000));
+    ASSERT_EQUAL(postings.size(), expected.size());
+
+    map<int, int> decoded;
+    int prev_id = -1;
+    for (const Posting posting : postings) {
+        ASSERT(posting.document_id > prev_id);
+        prev_id = posting.document_id;
+        decoded[posting.document_id] = posting.count;
+    }
+    ASSERT_EQUAL(decoded, expected);
+
+    ASSERT_EQUAL(postings.Find(3), expected.at(3));
+    ASSERT_EQUAL(postings.Find(4000), 2);
+    ASSERT_EQUAL(postings.Find(6), 0);
+    ASSERT(postings.GetMemoryUsage() < expected.size() * sizeof(Posting));
+}
+
+// Тест проверяет, таблицу документов. Доступ по порядковому номеру идёт в порядке возрастания id, освободившиеся слоты переиспользуются.
+void TestDocumentTable() {
+    using namespace std;
+
+    {
+        DocumentTable table;
+        const int slot5 = table.Add(5, 3, DocumentStatus::ACTUAL, 4);
+        table.Add(2, -1, DocumentStatus::BANNED, 2);
+        table.Add(9, 7, DocumentStatus::IRRELEVANT, 1);
+        ASSERT_EQUAL(table.size(), 3);
+        ASSERT_EQUAL(vector<int>(table.begin(), table.end()), (vector<int>{ 2, 5, 9 }));
+        ASSERT_EQUAL(table.GetIdAt(1), 5);
+
+        const int slot2 = table.FindSlot(2);
+        ASSERT_EQUAL(table.GetRating(slot2), -1);
+        ASSERT(table.GetStatus(slot2) == DocumentStatus::BANNED);
+        ASSERT_EQUAL(table.GetWordCount(slot5), 4);
+
+        ASSERT(table.Remove(5));
+        ASSERT(!table.Remove(5));
+        ASSERT_EQUAL(table.FindSlot(5), DocumentTable::NO_SLOT);
+        ASSERT_EQUAL(table.Add(7, 0, DocumentStatus::ACTUAL, 1), slot5);
+        ASSERT_EQUAL(table.GetSlotCount(), 3);
+        ASSERT_EQUAL(vector<int>(table.begin(), table.end()), (vector<int>{ 2, 7, 9 }));
+    }
+
+    {
+        // Порядок id хранится блоками: много добавлений и удалений вразнобой делят и убирают блоки
+        DocumentTable table;
+        set<int> expected;
+        mt19937 generator(7);
+        for (int step = 0; step < 20000; ++step) {
+            const int document_id = uniform_int_distribution<int>(0, 5000)(generator);
+            if (expected.count(document_id) > 0) {
+                ASSERT(table.Remove(document_id));
+                expected.erase(document_id);
+            }
+            else {
+                table.Add(document_id, 0, DocumentStatus::ACTUAL, 1);
+                expected.insert(document_id);
+            }
+        }
+        ASSERT_EQUAL(table.size(), static_cast<int>(expected.size()));
+        ASSERT_EQUAL(vector<int>(table.begin(), table.end()), vector<int>(expected.begin(), expected.end()));
+        int index = 0;
+        for (const int document_id : expected) {
+            ASSERT_EQUAL(table.GetIdAt(index++), document_id);
+        }
+        for (const int document_id : vector<int>(expected.begin(), expected.end())) {
+            ASSERT(table.Remove(document_id));
+        }
+        ASSERT(table.empty());
+        ASSERT(table.begin() == table.end());
+    }
+
+    {
+        SearchServer server;
+        server.AddDocument(4, "cat in the city"s, DocumentStatus::ACTUAL, { 1 });
+        server.AddDocument(1, "dog in the city"s, DocumentStatus::ACTUAL, { 2 });
+        server.AddDocument(3, "bird in the sky"s, DocumentStatus::ACTUAL, { 3 });
+        server.RemoveDocument(3);
+        ASSERT_EQUAL(server.GetDocumentCount(), 2);
+        ASSERT_EQUAL(server.GetDocumentId(0), 1);
+        ASSERT_EQUAL(server.GetDocumentId(1), 4);
+        ASSERT_EQUAL(vector<int>(server.begin(), server.end()), (vector<int>{ 1, 4 }));
+
+        bool thrown = false;
+        try {
+            server.GetDocumentId(2);
+        }
+        catch (const out_of_range&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+    }
+}
+
+// Тест проверяет, удаление документов. Удалённые сразу и помеченные надгробием документы не находятся, а релевантность остальных не меняется.
+void TestRemoveDocument() {
+    using namespace std;
+
+    const vector<string> contents = {
+        "white cat and fashion collar"s,
+        "fluffy cat fluffy tail"s,
+        "groomed dog expressive eyes"s,
+        "groomed starling evgen"s,
+        "black bat wayne with black ears"s,
+    };
+
+    auto fill = [&](SearchServer& server) {
+        for (int i = 0; i < static_cast<int>(contents.size()); ++i) {
+            server.AddDocument(i, contents[i], DocumentStatus::ACTUAL, { i });
+        }
+    };
+
+    SearchServer immediate("and with"s);
+    fill(immediate);
+    immediate.RemoveDocument(1);
+    immediate.RemoveDocument(3);
+    immediate.RemoveDocument(42);
+    ASSERT_EQUAL(immediate.GetDocumentCount(), 3);
+    ASSERT(immediate.GetWordFrequencies(1).empty());
+    ASSERT(immediate.FindTopDocuments("fluffy"s).empty());
+
+    SearchServer tombstone("and with"s);
+    tombstone.SetRemovalMode(RemovalMode::TOMBSTONE, 3);
+    fill(tombstone);
+    tombstone.RemoveDocument(1);
+    tombstone.RemoveDocument(3);
+    ASSERT_EQUAL(tombstone.GetTombstoneCount(), 2);
+    ASSERT_EQUAL(tombstone.GetDocumentCount(), 3);
+    ASSERT(tombstone.FindTopDocuments("fluffy"s).empty());
+
+    const auto expected = immediate.FindTopDocuments("groomed cat black -evgen"s);
+    const auto actual = tombstone.FindTopDocuments("groomed cat black -evgen"s);
+    ASSERT_EQUAL(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        ASSERT_EQUAL(actual[i].id, expected[i].id);
+        ASSERT(abs(actual[i].relevance - expected[i].relevance) < EPSILON);
+    }
+
+    // Повторное добавление id из надгробия не должно находиться по словам старого документа
+    tombstone.AddDocument(1, "spotted dog"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(tombstone.GetTombstoneCount(), 1);
+    ASSERT(tombstone.FindTopDocuments("fluffy"s).empty());
+    ASSERT_EQUAL(tombstone.FindTopDocuments("spotted"s).size(), 1u);
+
+    tombstone.RemoveDocument(0);
+    tombstone.RemoveDocument(2);
+    ASSERT_EQUAL(tombstone.GetTombstoneCount(), 0);
+    ASSERT(tombstone.FindTopDocuments("cat"s).empty());
+    ASSERT_EQUAL(tombstone.FindTopDocuments("black dog"s).size(), 2u);
+}
+
+// Тест проверяет, отбор лучших документов. Число результатов задаётся при вызове, порядок совпадает с сортировкой по релевантности и рейтингу.
+void TestTopDocumentsLimit() {
+    using namespace std;
+
+    {
+        TopDocuments top(3);
+        const vector<Document> documents = { { 1, 0.5, 1 }, { 2, 0.9, 0 }, { 3, 0.5, 7 }, { 4, 0.1, 9 }, { 5, 0.7, 2 } };
+        for (const Document& document : documents) {
+            top.Push(document);
+        }
+        ASSERT(top.IsFull());
+        ASSERT_EQUAL(top.GetWorst().id, 3);
+        const vector<Document> result = top.Extract();
+        ASSERT_EQUAL(result.size(), 3u);
+        ASSERT_EQUAL(result[0].id, 2);
+        ASSERT_EQUAL(result[1].id, 5);
+        ASSERT_EQUAL(result[2].id, 3);
+    }
+
+    {
+        SearchServer server("and with"s);
+        for (int i = 0; i < 20; ++i) {
+            server.AddDocument(i, "cat number "s + string(i % 7 + 1, 'x'), i % 2 ? DocumentStatus::ACTUAL : DocumentStatus::BANNED, { i });
+        }
+        ASSERT_EQUAL(server.FindTopDocuments("cat"s).size(), 5u);
+        ASSERT_EQUAL(server.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, 8).size(), 8u);
+        ASSERT_EQUAL(server.FindTopDocuments("cat"s, DocumentStatus::BANNED, 100).size(), 10u);
+        ASSERT(server.FindTopDocuments("cat"s, DocumentStatus::ACTUAL, 0).empty());
+
+        const auto all = server.FindTopDocuments("cat"s, [](int, DocumentStatus, int) { return true; }, 20);
+        ASSERT_EQUAL(all.size(), 20u);
+        for (size_t i = 1; i < all.size(); ++i) {
+            ASSERT(!TopDocuments::IsBetter(all[i], all[i - 1]));
+        }
+        ASSERT_EQUAL(all[0].id, 19);
+    }
+}
+
+// Тест проверяет, набор исключённых документов. Минус-слова исключают слот, сброс очищает только отмеченные слоты, повторные запросы дают тот же результат.
+void TestScoreAccumulator() {
+    using namespace std;
+
+    {
+        ScoreAccumulator::Lease lease;
+        ScoreAccumulator& scores = *lease;
+        scores.Reset(8);
+        scores.Exclude(3);
+        scores.Exclude(3);
+        scores.Exclude(7);
+        ASSERT(scores.IsExcluded(3));
+        ASSERT(scores.IsExcluded(7));
+        ASSERT(!scores.IsExcluded(5));
+
+        scores.Reset(4);
+        ASSERT(!scores.IsExcluded(3));
+        ASSERT(!scores.IsExcluded(7));
+        scores.Reset(16);
+        scores.Exclude(12);
+        ASSERT(scores.IsExcluded(12));
+        ASSERT(!scores.IsExcluded(3));
+    }
+
+    {
+        ScoreAccumulator::Lease outer;
+        ScoreAccumulator* const outer_accumulator = &*outer;
+        {
+            ScoreAccumulator::Lease inner;
+            ASSERT(&*inner != outer_accumulator);
+        }
+        ScoreAccumulator::Lease reused;
+        ASSERT(&*reused != outer_accumulator);
+    }
+
+    {
+        SearchServer server("and with"s);
+        server.AddDocument(1, "white cat and fashion collar"s, DocumentStatus::ACTUAL, { 8, -3 });
+        server.AddDocument(2, "fluffy cat fluffy tail"s, DocumentStatus::ACTUAL, { 7, 2, 7 });
+        server.AddDocument(3, "groomed dog expressive eyes"s, DocumentStatus::ACTUAL, { 5, -12, 2, 1 });
+        const auto first = server.FindTopDocuments("fluffy groomed cat -collar"s);
+        const auto second = server.FindTopDocuments("fluffy groomed cat -collar"s);
+        ASSERT_EQUAL(first.size(), 2u);
+        ASSERT_EQUAL(second.size(), 2u);
+        ASSERT_EQUAL(first[0].id, 2);
+        ASSERT_EQUAL(second[0].id, 2);
+        ASSERT(abs(first[1].relevance - second[1].relevance) < EPSILON);
+        ASSERT(server.FindTopDocuments("cat -cat"s).empty());
+    }
+}
+
+// Тест проверяет, параллельный поиск. Результаты с std::execution::par совпадают с последовательным поиском.
+void TestParallelFindTopDocuments() {
+    using namespace std;
+
+    const vector<string> words = { "cat"s, "dog"s, "bird"s, "fish"s, "tail"s, "ears"s, "collar"s, "fluffy"s, "groomed"s, "black"s };
+    SearchServer server("and with"s);
+    mt19937 generator(42);
+    for (int document_id = 0; document_id < 600; ++document_id) {
+        string text;
+        for (int i = 0; i < 6; ++i) {
+            text += words[uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)] + " "s;
+        }
+        server.AddDocument(document_id * 3, text, static_cast<DocumentStatus>(document_id % 4), { document_id % 11 - 5 });
+    }
+
+    const vector<string> queries = { "cat"s, "fluffy cat -dog"s, "bird fish tail ears -collar -black"s, "groomed"s, "starling"s, "cat -cat"s };
+    for (const string& query : queries) {
+        for (const int max_count : { 1, 5, 50 }) {
+            const auto seq = server.FindTopDocuments(execution::seq, query, DocumentStatus::ACTUAL, max_count);
+            const auto par = server.FindTopDocuments(execution::par, query, DocumentStatus::ACTUAL, max_count);
+            ASSERT_EQUAL(seq.size(), par.size());
+            for (size_t i = 0; i < seq.size(); ++i) {
+                ASSERT_EQUAL(seq[i].id, par[i].id);
+                ASSERT_EQUAL(seq[i].relevance, par[i].relevance);
+                ASSERT_EQUAL(seq[i].rating, par[i].rating);
+            }
+        }
+    }
+
+    // Предикат вызывается не больше одного раза на документ
+    mutex calls_mutex;
+    map<int, int> calls;
+    server.FindTopDocuments(execution::par, "cat dog bird -fish"s, [&](int document_id, DocumentStatus, int) {
+        lock_guard guard(calls_mutex);
+        ++calls[document_id];
+        return true;
+    });
+    ASSERT(!calls.empty());
+    for (const auto& [document_id, count] : calls) {
+        ASSERT_EQUAL(count, 1);
+    }
+
+    const auto even = server.FindTopDocuments(execution::par, "cat dog"s, [](int document_id, DocumentStatus, int) { return document_id % 2 == 0; });
+    for (const Document& document : even) {
+        ASSERT_EQUAL(document.id % 2, 0);
+    }
+    ASSERT_EQUAL(server.FindTopDocuments(execution::par, "fish"s).size(), server.FindTopDocuments("fish"s).size());
+}
+
+// Тест проверяет, пакетную обработку запросов. Результаты приходят в порядке запросов и совпадают с последовательным поиском.
+void TestProcessQueries() {
+    using namespace std;
+
+    SearchServer server("and with"s);
+    const vector<string> contents = {
+        "funny pet and nasty rat"s,
+        "funny pet with curly hair"s,
+        "funny pet and not very nasty rat"s,
+        "pet with rat and rat and rat"s,
+        "nasty rat with curly hair"s,
+    };
+    for (int i = 0; i < static_cast<int>(contents.size()); ++i) {
+        server.AddDocument(i + 1, contents[i], DocumentStatus::ACTUAL, { i });
+    }
+
+    const vector<string> queries = { "nasty rat -not"s, "not very funny nasty pet"s, "curly hair"s, "starling"s };
+    const auto results = ProcessQueries(server, queries);
+    ASSERT_EQUAL(results.size(), queries.size());
+    vector<int> expected_ids;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const auto expected = server.FindTopDocuments(queries[i]);
+        ASSERT_EQUAL(results[i].size(), expected.size());
+        for (size_t j = 0; j < expected.size(); ++j) {
+            ASSERT_EQUAL(results[i][j].id, expected[j].id);
+            expected_ids.push_back(expected[j].id);
+        }
+    }
+
+    vector<int> joined_ids;
+    for (const Document& document : ProcessQueriesJoined(server, queries)) {
+        joined_ids.push_back(document.id);
+    }
+    ASSERT_EQUAL(joined_ids, expected_ids);
+
+    bool thrown = false;
+    try {
+        ProcessQueries(server, { "curly"s, "--rat"s });
+    }
+    catch (const invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+
+    // Пустые результаты в середине пакета не оставляют дыр в склеенном результате
+    vector<string> many_queries;
+    vector<int> many_expected_ids;
+    for (int i = 0; i < 40; ++i) {
+        many_queries.push_back(i % 3 == 0 ? "starling"s : queries[i % queries.size()]);
+        for (const Document& document : server.FindTopDocuments(many_queries.back())) {
+            many_expected_ids.push_back(document.id);
+        }
+    }
+    vector<int> many_joined_ids;
+    for (const Document& document : ProcessQueriesJoined(server, many_queries)) {
+        many_joined_ids.push_back(document.id);
+    }
+    ASSERT_EQUAL(many_joined_ids, many_expected_ids);
+
+    thrown = false;
+    try {
+        ProcessQueriesJoined(server, { "curly"s, "--rat"s });
+    }
+    catch (const invalid_argument&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+// Тест проверяет параллельный матчинг документа. Результат совпадает с последовательным, найденные слова ссылаются на строки сервера.
+void TestParallelMatchDocument() {
+    using namespace std;
+
+    SearchServer server("and with"s);
+    server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, { 7, 2, 7 });
+    server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::BANNED, { 1, 2 });
+    server.AddDocument(3, "nasty rat with curly hair"s, DocumentStatus::IRRELEVANT, { 1, 2 });
+
+    const string query = "curly nasty cat -hair rat pet funny"s;
+    for (int document_id = 1; document_id <= 3; ++document_id) {
+        const auto [seq_words, seq_status] = server.MatchDocument(execution::seq, query, document_id);
+        const auto [par_words, par_status] = server.MatchDocument(execution::par, query, document_id);
+        ASSERT_EQUAL(seq_words, par_words);
+        ASSERT(seq_status == par_status);
+    }
+
+    const auto [words, status] = server.MatchDocument(execution::par, "rat funny pet cat"s, 1);
+    ASSERT_EQUAL(words, (vector<string_view>{ "funny"sv, "pet"sv, "rat"sv }));
+    ASSERT(status == DocumentStatus::ACTUAL);
+    ASSERT(get<0>(server.MatchDocument(execution::par, "curly -hair"s, 2)).empty());
+
+    // Слова возвращаются как представления строк, которыми владеет сервер
+    const auto [first_words, first_status] = server.MatchDocument("pet"s, 1);
+    const auto [second_words, second_status] = server.MatchDocument("pet"s, 2);
+    ASSERT_EQUAL(first_words.size(), 1u);
+    ASSERT(first_words[0].data() == second_words[0].data());
+
+    bool thrown = false;
+    try {
+        server.MatchDocument(execution::par, "pet"s, 42);
+    }
+    catch (const out_of_range&) {
+        thrown = true;
+    }
+    ASSERT(thrown);
+}
+
+// Тест проверяет, что сервер принимает std::string_view и хранит собственные копии слов документа.
+void TestStringViewApi() {
+    using namespace std;
+
+    const vector<string_view> stop_words = { "and"sv, "with"sv };
+    SearchServer server(stop_words);
+    {
+        string text = "funny pet and nasty rat"s;
+        server.AddDocument(1, string_view(text), DocumentStatus::ACTUAL, { 7, 2, 7 });
+        text = "funny pet with curly hair"s;
+        server.AddDocument(2, text, DocumentStatus::ACTUAL, { 1, 2 });
+        text.assign(text.size(), 'x');
+    }
+
+    // Запрос может быть частью более длинной строки
+    const string buffer = "curly hair|nasty rat"s;
+    const string_view query = string_view(buffer).substr(0, 10);
+    const auto result = server.FindTopDocuments(query);
+    ASSERT_EQUAL(result.size(), 1u);
+    ASSERT_EQUAL(result[0].id, 2);
+
+    const auto [words, status] = server.MatchDocument("pet and rat"sv, 1);
+    ASSERT_EQUAL(words, (vector<string_view>{ "pet"sv, "rat"sv }));
+
+    SearchServer literal_server("and with");
+    literal_server.AddDocument(1, "cat and dog", DocumentStatus::ACTUAL, { 1 });
+    ASSERT(literal_server.FindTopDocuments("and").empty());
+    ASSERT_EQUAL(literal_server.FindTopDocuments("dog").size(), 1u);
+}
+
+// Тест проверяет, поиск с отсечением по верхним оценкам вклада слов. Результаты совпадают с полным перебором.
+void TestDynamicPruning() {
+    using namespace std;
+
+    PostingList postings;
+    for (int document_id = 0; document_id < 1000; document_id += 2) {
+        postings.Insert(document_id, 1, document_id == 500 ? 0.5 : 0.1);
+    }
+    ASSERT(abs(postings.GetMaxWeight() - 0.5) < EPSILON);
+    ASSERT(abs(postings.GetBlock(postings.FindBlock(500)).max_weight - 0.5) < EPSILON);
+    ASSERT(abs(postings.GetBlock(0).max_weight - 0.1) < EPSILON);
+    auto it = postings.begin();
+    it.SkipTo(501);
+    ASSERT_EQUAL(it->document_id, 502);
+    it.SkipTo(998);
+    ASSERT_EQUAL(it->document_id, 998);
+    it.SkipTo(999);
+    ASSERT(it == postings.end());
+
+    // Частоты слов убывают по закону Ципфа, как в текстах на естественном языке
+    vector<string> words;
+    vector<double> weights;
+    for (int i = 0; i < 300; ++i) {
+        words.push_back("w"s + to_string(i));
+        weights.push_back(1.0 / (i + 1));
+    }
+    mt19937 generator(7);
+    discrete_distribution<int> word_distribution(weights.begin(), weights.end());
+    SearchServer server("w0"s);
+    for (int document_id = 0; document_id < 3000; ++document_id) {
+        string text;
+        const int length = uniform_int_distribution<int>(3, 40)(generator);
+        for (int i = 0; i < length; ++i) {
+            text += words[word_distribution(generator)] + " "s;
+        }
+        server.AddDocument(document_id * 2 + 1, text, static_cast<DocumentStatus>(document_id % 4), { document_id % 7 });
+    }
+    server.SetRemovalMode(RemovalMode::TOMBSTONE);
+    for (int document_id = 1; document_id < 6000; document_id += 10) {
+        server.RemoveDocument(document_id);
+    }
+
+    for (int i = 0; i < 200; ++i) {
+        string query;
+        for (int j = 0; j < 5; ++j) {
+            if (j == 4 && i % 3 == 0) {
+                query += "-"s;
+            }
+            query += words[uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)] + " "s;
+        }
+        const int max_count = i % 4 == 0 ? 50 : 5;
+        const auto predicate = [i](int, DocumentStatus status, int rating) {
+            return i % 2 == 0 ? status == DocumentStatus::ACTUAL : rating > 2;
+        };
+        const auto pruned = server.FindTopDocuments(query, predicate, max_count);
+        const auto exhaustive = server.FindTopDocuments(execution::par, query, predicate, max_count);
+        ASSERT_EQUAL(pruned.size(), exhaustive.size());
+        for (size_t k = 0; k < pruned.size(); ++k) {
+            ASSERT(abs(pruned[k].relevance - exhaustive[k].relevance) < EPSILON);
+            ASSERT_EQUAL(pruned[k].rating, exhaustive[k].rating);
+        }
+    }
+}
+
+// Тест проверяет, статистику корпуса. Документные частоты и IDF обновляются при добавлении и удалении документов.
+void TestCorpusStatistics() {
+    using namespace std;
+
+    CorpusStatistics statistics;
+    statistics.Resize(3);
+    statistics.AddDocument({ 0, 1 });
+    statistics.AddDocument({ 0 });
+    statistics.AddDocument({ 0, 2 });
+    statistics.AddDocument({ 1 });
+    ASSERT_EQUAL(statistics.GetDocumentCount(), 4);
+    ASSERT_EQUAL(statistics.GetDocumentFrequency(0), 3);
+    ASSERT(abs(statistics.GetInverseDocumentFreq(0) - log(4.0 / 3)) < EPSILON);
+    ASSERT(abs(statistics.GetInverseDocumentFreq(2) - log(4.0)) < EPSILON);
+
+    // Изменения накапливаются и применяются при следующем чтении
+    statistics.RemoveDocument({ 0, 2 });
+    statistics.RemoveDocument({ 0 });
+    statistics.Resize(4);
+    statistics.AddDocument({ 3 });
+    ASSERT_EQUAL(statistics.GetDocumentFrequency(0), 1);
+    ASSERT_EQUAL(statistics.GetDocumentFrequency(2), 0);
+    ASSERT(abs(statistics.GetInverseDocumentFreq(0) - log(3.0)) < EPSILON);
+    ASSERT(abs(statistics.GetInverseDocumentFreq(1) - log(3.0 / 2)) < EPSILON);
+    ASSERT(abs(statistics.GetInverseDocumentFreq(3) - log(3.0)) < EPSILON);
+
+    CorpusStatistics copy = statistics;
+    statistics.AddDocument({ 1 });
+    ASSERT_EQUAL(copy.GetDocumentCount(), 3);
+    ASSERT(abs(copy.GetInverseDocumentFreq(1) - log(3.0 / 2)) < EPSILON);
+    ASSERT(abs(statistics.GetInverseDocumentFreq(1) - log(4.0 / 3)) < EPSILON);
+
+    // Перенесённая статистика досчитывает логарифмы при первом чтении
+    statistics.AddDocument({ 2 });
+    copy = move(statistics);
+    ASSERT_EQUAL(copy.GetDocumentCount(), 5);
+    ASSERT(abs(copy.GetInverseDocumentFreq(2) - log(5.0)) < EPSILON);
+    ASSERT(abs(copy.GetInverseDocumentFreq(1) - log(5.0 / 3)) < EPSILON);
+
+    // Первое чтение после пачки изменений может прийти из нескольких потоков сразу
+    SearchServer server("and with"s);
+    for (int document_id = 0; document_id < 100; ++document_id) {
+        server.AddDocument(document_id, document_id % 2 == 0 ? "white cat"s : "black dog"s, DocumentStatus::ACTUAL, { 1 });
+    }
+    vector<string> queries(50, "cat"s);
+    for (const vector<Document>& documents : ProcessQueries(server, queries)) {
+        ASSERT_EQUAL(documents.size(), 5u);
+        ASSERT(abs(documents[0].relevance - 0.5 * log(2.0)) < EPSILON);
+    }
+    for (int document_id = 1; document_id < 100; document_id += 2) {
+        server.RemoveDocument(document_id);
+    }
+    for (const vector<Document>& documents : ProcessQueries(server, queries)) {
+        ASSERT(abs(documents[0].relevance) < EPSILON);
+    }
+}
+
+// Тест проверяет, кэш результатов поиска. Повторный запрос берётся из кэша, изменение индекса делает кэш недействительным, редкие запросы не вытесняют частые.
+void TestResultCache() {
+    using namespace std;
+
+    SearchServer server("and with"s);
+    server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, { 7, 2, 7 });
+    server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::BANNED, { 1, 2 });
+
+    auto cache = make_shared<ResultCache>(2);
+    RequestQueue queue(server, cache);
+    ASSERT_EQUAL(queue.AddFindRequest("funny  rat"s).size(), 1u);
+    ASSERT_EQUAL(queue.AddFindRequest("rat funny rat"s).size(), 1u);
+    ASSERT_EQUAL(queue.GetCacheStats().hits, 1u);
+    ASSERT_EQUAL(queue.GetCacheStats().misses, 1u);
+
+    // Поиск по другому статусу и с предикатом не берёт чужой результат
+    ASSERT_EQUAL(queue.AddFindRequest("funny rat"s, DocumentStatus::BANNED)[0].id, 2);
+    const auto even = [](int document_id, DocumentStatus, int) { return document_id % 2 == 0; };
+    ASSERT_EQUAL(queue.AddFindRequest("funny"s, even)[0].id, 2);
+    ASSERT_EQUAL(queue.GetCacheStats().hits, 1u);
+
+    // После изменения индекса закэшированный результат не используется
+    server.AddDocument(3, "funny cat"s, DocumentStatus::ACTUAL, { 9 });
+    ASSERT_EQUAL(queue.AddFindRequest("funny rat"s).size(), 2u);
+    ASSERT_EQUAL(queue.GetCacheStats().hits, 1u);
+
+    // Счётчики скетча упакованы по два в байт: соседние не мешают друг другу, насыщаются на 15 и вместе делятся пополам
+    FrequencySketch sketch(64);
+    for (int i = 0; i < 20; ++i) {
+        sketch.Increment(1);
+    }
+    for (int i = 0; i < 3; ++i) {
+        sketch.Increment(2);
+    }
+    ASSERT_EQUAL(sketch.Estimate(1), 15);
+    ASSERT(sketch.Estimate(2) >= 3);
+    ASSERT(sketch.Estimate(2) < 15);
+    for (int i = 0; i < 640; ++i) {
+        sketch.Increment(1000 + i);
+    }
+    ASSERT(sketch.Estimate(1) <= 8);
+
+    // Редкий запрос не вытесняет частые
+    ResultCache small_cache(2);
+    for (int i = 0; i < 5; ++i) {
+        for (const string& key : { "a"s, "b"s }) {
+            if (!small_cache.Find(key, 0)) {
+                small_cache.Insert(key, 0, { { 1, 0.5, 1 } });
+            }
+        }
+    }
+    ASSERT(!small_cache.Find("c"s, 0));
+    small_cache.Insert("c"s, 0, {});
+    ASSERT(small_cache.Find("a"s, 0));
+    ASSERT(small_cache.Find("b"s, 0));
+    ASSERT_EQUAL(small_cache.GetStats().rejections, 1u);
+    for (int i = 0; i < 10; ++i) {
+        small_cache.Find("c"s, 0);
+    }
+    small_cache.Insert("c"s, 0, {});
+    ASSERT_EQUAL(small_cache.GetStats().evictions, 1u);
+    ASSERT_EQUAL(small_cache.size(), 2u);
+    ASSERT(small_cache.Find("c"s, 0));
+    ASSERT(!small_cache.Find("c"s, 1));
+
+    // Общий кэш для очередей из разных потоков
+    auto shared_cache = make_shared<ResultCache>();
+    vector<int> found(8);
+    for_each(execution::par, found.begin(), found.end(), [&](int& count) {
+        RequestQueue thread_queue(server, shared_cache);
+        for (int i = 0; i < 100; ++i) {
+            count += static_cast<int>(thread_queue.AddFindRequest(i % 2 == 0 ? "funny"s : "curly hair"s).size());
+        }
+    });
+    for (const int count : found) {
+        ASSERT_EQUAL(count, 50 * 2);
+    }
+    const ResultCache::Stats stats = shared_cache->GetStats();
+    ASSERT_EQUAL(stats.hits + stats.misses, 800u);
+}
+
+// Тест проверяет, кэш скомпилированных запросов. Повторный запрос даёт тот же результат, а изменения словаря и стоп-слов учитываются.
+void TestQueryPlanCache() {
+    using namespace std;
+
+    SmallVector<int, 4> small;
+    for (int i = 0; i < 10; ++i) {
+        small.push_back(9 - i % 5);
+    }
+    ASSERT_EQUAL(small.size(), 10u);
+    sort(small.begin(), small.end());
+    small.erase(unique(small.begin(), small.end()), small.end());
+    ASSERT_EQUAL(vector<int>(small.begin(), small.end()), (vector<int>{ 5, 6, 7, 8, 9 }));
+    small.erase(small.begin() + 3, small.end());
+    const SmallVector<int, 4> copy = small;
+    ASSERT_EQUAL(vector<int>(copy.begin(), copy.end()), (vector<int>{ 5, 6, 7 }));
+
+    SearchServer server("and with"s);
+    server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, { 7 });
+    ASSERT(server.FindTopDocuments("cat -dog"s).empty());
+    ASSERT_EQUAL(server.FindTopDocuments("pet pet rat -dog"s).size(), 1u);
+
+    // План с незнакомыми словами перестраивается, когда слова появляются в индексе
+    server.AddDocument(2, "curly cat"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(server.FindTopDocuments("cat -dog"s).size(), 1u);
+    server.AddDocument(3, "pet dog"s, DocumentStatus::ACTUAL, { 1 });
+    ASSERT_EQUAL(server.FindTopDocuments("pet pet rat -dog"s).size(), 1u);
+    ASSERT_EQUAL(get<0>(server.MatchDocument("pet pet rat -dog"s, 1)).size(), 2u);
+    ASSERT(get<0>(server.MatchDocument("pet pet rat -dog"s, 3)).empty());
+
+    // Новые стоп-слова сбрасывают кэш планов
+    server.SetStopWords("cat"s);
+    ASSERT(server.FindTopDocuments("cat -dog"s).empty());
+
+    for (int i = 0; i < 2; ++i) {
+        bool thrown = false;
+        try {
+            server.FindTopDocuments("pet --rat"s);
+        }
+        catch (const invalid_argument&) {
+            thrown = true;
+        }
+        ASSERT(thrown);
+    }
+
+    // Кэш планов общий для всех индексов потока: одинаковый текст запроса к серверу с другим словарём
+    // не берёт чужой план
+    SearchServer other;
+    other.AddDocument(1, "rat rat"s, DocumentStatus::ACTUAL, { 1 });
+    other.AddDocument(2, "pet dog"s, DocumentStatus::ACTUAL, { 1 });
+    const auto found = other.FindTopDocuments("pet pet rat -dog"s);
+    ASSERT_EQUAL(found.size(), 1u);
+    ASSERT_EQUAL(found[0].id, 1);
+    ASSERT_EQUAL(server.FindTopDocuments("pet pet rat -dog"s)[0].id, 1);
+
+    // Планы строятся в каждом потоке свои
+    const int expected = static_cast<int>(server.FindTopDocuments("curly pet"s).size() * 25
+        + server.FindTopDocuments("rat"s).size() * 25);
+    vector<int> thread_counts(8);
+    for_each(execution::par, thread_counts.begin(), thread_counts.end(), [&](int& count) {
+        for (int i = 0; i < 50; ++i) {
+            count += static_cast<int>(server.FindTopDocuments(i % 2 == 0 ? "curly pet"s : "rat"s).size());
+        }
+    });
+    for (const int count : thread_counts) {
+        ASSERT_EQUAL(count, expected);
+    }
+}
+
+// Тест проверяет, сегментированный индекс. Поиск по нескольким сегментам совпадает с поиском по одному, слияние убирает удалённые документы.
+void TestSegmentedIndex() {
+    using namespace std;
+
+    {
+        IndexSegment first(1);
+        first.AddDocument(4, { { 0, 1 }, { 1, 1 } }, 2);
+        first.AddDocument(2, { { 0, 2 } }, 2);
+        first.Seal();
+        IndexSegment second(2);
+        second.AddDocument(3, { { 0, 1 }, { 2, 3 } }, 4);
+        second.Seal();
+        ASSERT_EQUAL(first.GetDocumentIds(), (vector<int>{ 2, 4 }));
+        ASSERT(first.Find(2).empty());
+
+        const auto merged = IndexSegment::Merge(3, {
+            { make_shared<IndexSegment>(first), { { 2, 2 } } },
+            { make_shared<IndexSegment>(second), { { 3, 4 } } },
+        });
+        ASSERT_EQUAL(merged->GetId(), 3);
+        ASSERT_EQUAL(merged->GetDocumentIds(), (vector<int>{ 2, 3 }));
+        ASSERT_EQUAL(merged->Find(0).size(), 2u);
+        ASSERT_EQUAL(merged->Find(0).Find(2), 2);
+        ASSERT(merged->Find(1).empty());
+        ASSERT(abs(merged->Find(2).GetMaxWeight() - 0.75) < EPSILON);
+    }
+
+    const vector<string> words = { "cat"s, "dog"s, "bird"s, "fish"s, "tail"s, "ears"s, "collar"s, "fluffy"s, "groomed"s, "black"s, "and"s };
+    mt19937 generator(17);
+    const auto make_text = [&]() {
+        string text;
+        const int length = uniform_int_distribution<int>(1, 8)(generator);
+        for (int i = 0; i < length; ++i) {
+            text += words[uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)] + " "s;
+        }
+        return text;
+    };
+    const vector<string> queries = { "cat"s, "fluffy cat -dog"s, "bird fish tail ears -collar -black"s, "groomed collar"s, "starling"s };
+
+    for (const RemovalMode mode : { RemovalMode::IMMEDIATE, RemovalMode::TOMBSTONE }) {
+        SearchServer segmented("and"s);
+        segmented.SetRemovalMode(mode, 50);
+        segmented.SetSegmentPolicy(16, 2);
+        SearchServer reference("and"s);
+        reference.SetSegmentPolicy(100000);
+        const auto add = [&](int document_id) {
+            const string text = make_text();
+            segmented.AddDocument(document_id, text, DocumentStatus::ACTUAL, { document_id % 5 });
+            reference.AddDocument(document_id, text, DocumentStatus::ACTUAL, { document_id % 5 });
+        };
+        const auto remove = [&](int document_id) {
+            segmented.RemoveDocument(document_id);
+            reference.RemoveDocument(document_id);
+        };
+        const auto check = [&]() {
+            for (const string& query : queries) {
+                const auto expected = reference.FindTopDocuments(query, DocumentStatus::ACTUAL, 20);
+                const auto seq = segmented.FindTopDocuments(query, DocumentStatus::ACTUAL, 20);
+                const auto par = segmented.FindTopDocuments(execution::par, query, DocumentStatus::ACTUAL, 20);
+                ASSERT_EQUAL(seq.size(), expected.size());
+                ASSERT_EQUAL(par.size(), expected.size());
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    ASSERT(abs(seq[i].relevance - expected[i].relevance) < EPSILON);
+                    ASSERT(abs(par[i].relevance - expected[i].relevance) < EPSILON);
+                    ASSERT_EQUAL(seq[i].rating, expected[i].rating);
+                }
+            }
+        };
+
+        for (int document_id = 0; document_id < 400; ++document_id) {
+            add(document_id);
+            if (document_id % 7 == 3) {
+                remove(document_id / 2);
+            }
+        }
+        check();
+
+        // Удалённые из запечатанных сегментов id добавляются заново с другим текстом
+        for (int document_id = 0; document_id < 200; document_id += 4) {
+            remove(document_id);
+            add(document_id);
+        }
+        check();
+
+        segmented.WaitForMerges();
+        ASSERT(segmented.GetSegmentCount() < 400 / 16);
+        ASSERT_EQUAL(segmented.GetDocumentCount(), reference.GetDocumentCount());
+        check();
+
+        segmented.Compact();
+        ASSERT_EQUAL(segmented.GetTombstoneCount(), 0);
+        check();
+    }
+
+    // Слияние переписывает сегмент, в котором удалено больше половины документов
+    SearchServer server;
+    server.SetRemovalMode(RemovalMode::TOMBSTONE);
+    server.SetSegmentPolicy(10, 4);
+    for (int document_id = 0; document_id < 10; ++document_id) {
+        server.AddDocument(document_id, "cat number n"s + to_string(document_id), DocumentStatus::ACTUAL, { 1 });
+    }
+    ASSERT_EQUAL(server.GetSegmentCount(), 2);
+    for (int document_id = 0; document_id < 6; ++document_id) {
+        server.RemoveDocument(document_id);
+    }
+    server.WaitForMerges();
+    ASSERT_EQUAL(server.GetTombstoneCount(), 0);
+    ASSERT_EQUAL(server.FindTopDocuments("cat"s).size(), 4u);
+
+    // В режиме IMMEDIATE удаление из запечатанного сегмента только ставит надгробие, а сегменты
+    // переписываются, когда надгробий набирается порог. Сегмент записи меняется на месте
+    SearchServer immediate;
+    immediate.SetRemovalMode(RemovalMode::IMMEDIATE, 4);
+    immediate.SetSegmentPolicy(10, 100);
+    for (int document_id = 0; document_id < 22; ++document_id) {
+        immediate.AddDocument(document_id, "dog number n"s + to_string(document_id), DocumentStatus::ACTUAL, { 1 });
+    }
+    ASSERT_EQUAL(immediate.GetSegmentCount(), 3);
+    immediate.RemoveDocument(21);
+    ASSERT_EQUAL(immediate.GetTombstoneCount(), 0);
+    for (int document_id = 0; document_id < 3; ++document_id) {
+        immediate.RemoveDocument(document_id * 5);
+    }
+    ASSERT_EQUAL(immediate.GetTombstoneCount(), 3);
+    ASSERT(immediate.FindTopDocuments("n5"s).empty());
+    ASSERT_EQUAL(immediate.FindTopDocuments("dog"s, DocumentStatus::ACTUAL, 100).size(), 18u);
+    immediate.RemoveDocument(15);
+    ASSERT_EQUAL(immediate.GetTombstoneCount(), 0);
+    ASSERT_EQUAL(immediate.GetSegmentCount(), 3);
+    ASSERT_EQUAL(immediate.FindTopDocuments("dog"s, DocumentStatus::ACTUAL, 100).size(), 17u);
+    ASSERT_EQUAL(immediate.FindTopDocuments("n16"s).size(), 1u);
+}
+
+// Функция TestSearchServer является точкой входа для запуска тестов
+// Тест проверяет, что сервер с шардами находит те же документы с той же релевантностью, что и сервер со всеми документами
+void TestShardedSearchServer() {
+    using namespace std;
+
+    const vector<string> words = { "cat"s, "dog"s, "bird"s, "fish"s, "tail"s, "ears"s, "collar"s, "fluffy"s, "groomed"s, "black"s, "and"s };
+    mt19937 generator(23);
+    vector<string> texts;
+    for (int document_id = 0; document_id < 300; ++document_id) {
+        string text;
+        const int length = uniform_int_distribution<int>(1, 8)(generator);
+        for (int i = 0; i < length; ++i) {
+            text += words[uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)] + " "s;
+        }
+        texts.push_back(text);
+    }
+    const vector<string> queries = { "cat"s, "fluffy cat -dog"s, "bird fish tail ears -collar -black"s, "groomed collar and"s, "starling"s };
+
+    for (const int shard_count : { 1, 3, 8 }) {
+        SearchServer reference("and"s);
+        ShardedSearchServer sharded("and"s, shard_count);
+        ASSERT_EQUAL(sharded.GetShardCount(), shard_count);
+        for (int document_id = 0; document_id < static_cast<int>(texts.size()); ++document_id) {
+            const DocumentStatus status = document_id % 7 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+            reference.AddDocument(document_id, texts[document_id], status, { document_id });
+            sharded.AddDocument(document_id, texts[document_id], status, { document_id });
+        }
+        const auto check = [&]() {
+            ASSERT_EQUAL(sharded.GetDocumentCount(), reference.GetDocumentCount());
+            for (const string& query : queries) {
+                for (const int max_count : { 1, 5, 50 }) {
+                    const auto expected = reference.FindTopDocuments(query, DocumentStatus::ACTUAL, max_count);
+                    const auto found = sharded.FindTopDocuments(query, DocumentStatus::ACTUAL, max_count);
+                    ASSERT_EQUAL(found.size(), expected.size());
+                    for (size_t i = 0; i < found.size(); ++i) {
+                        ASSERT_EQUAL(found[i].id, expected[i].id);
+                        ASSERT_EQUAL(found[i].relevance, expected[i].relevance);
+                        ASSERT_EQUAL(found[i].rating, expected[i].rating);
+                    }
+                }
+                for (const int document_id : { 3, 14, 150 }) {
+                    ASSERT_EQUAL(get<0>(sharded.MatchDocument(query, document_id)), get<0>(reference.MatchDocument(query, document_id)));
+                }
+            }
+        };
+        check();
+        for (int document_id = 0; document_id < 300; document_id += 4) {
+            reference.RemoveDocument(document_id);
+            sharded.RemoveDocument(document_id);
+        }
+        check();
+
+        int total = 0;
+        for (int index = 0; index < shard_count; ++index) {
+            total += sharded.GetShard(index).GetDocumentCount();
+        }
+        ASSERT_EQUAL(total, sharded.GetDocumentCount());
+        ASSERT(sharded.GetShard(sharded.GetShardIndex(5)).GetDocumentCount() > 0);
+
+        try {
+            sharded.AddDocument(5, "dog"s, DocumentStatus::ACTUAL, {});
+            ASSERT_HINT(false, "Duplicate document id must be rejected"s);
+        }
+        catch (const invalid_argument&) {
+        }
+        try {
+            sharded.FindTopDocuments("cat --dog"s);
+            ASSERT_HINT(false, "Bad query must be rejected"s);
+        }
+        catch (const invalid_argument&) {
+        }
+    }
+}
+
+// Тест проверяет, сохранение индекса в файл и загрузку из него. Загруженный сервер ищет так же, как исходный, и продолжает меняться
+void TestIndexFile() {
+    using namespace std;
+
+    const vector<string> words = { "cat"s, "dog"s, "bird"s, "fish"s, "tail"s, "ears"s, "collar"s, "fluffy"s, "groomed"s, "black"s, "and"s };
+    mt19937 generator(29);
+    const auto make_text = [&]() {
+        string text;
+        const int length = uniform_int_distribution<int>(1, 8)(generator);
+        for (int i = 0; i < length; ++i) {
+            text += words[uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)] + " "s;
+        }
+        return text;
+    };
+    const vector<string> queries = { "cat"s, "fluffy cat -dog"s, "bird fish tail ears -collar -black"s, "groomed collar and"s, "starling"s, "starling cat"s };
+
+    SearchServer original("and"s);
+    original.SetRemovalMode(RemovalMode::TOMBSTONE, 1000);
+    original.SetSegmentPolicy(32, 4);
+    for (int document_id = 0; document_id < 200; ++document_id) {
+        const DocumentStatus status = document_id % 7 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL;
+        original.AddDocument(document_id * 3, make_text(), status, { document_id, 1 });
+    }
+    for (int document_id = 0; document_id < 600; document_id += 15) {
+        original.RemoveDocument(document_id);
+    }
+    ASSERT(original.GetSegmentCount() > 1);
+    ASSERT(original.GetTombstoneCount() > 0);
+
+    const string path = (filesystem::temp_directory_path() / "search_server_test.index"s).string();
+    original.Save(path);
+
+    SearchServer loaded;
+    loaded.AddDocument(1000, "starling"s, DocumentStatus::ACTUAL, {});
+    // Слова из MatchDocument переживают загрузку файла: прежний словарь и файл остаются в памяти
+    const vector<string_view> memory_words = get<0>(loaded.MatchDocument("starling"s, 1000));
+    loaded.Load(path, true);
+    ASSERT_EQUAL(memory_words, (vector<string_view>{ "starling"sv }));
+
+    const auto check = [&](const SearchServer& expected, const SearchServer& actual) {
+        ASSERT_EQUAL(actual.GetDocumentCount(), expected.GetDocumentCount());
+        vector<int> expected_ids(expected.begin(), expected.end());
+        vector<int> actual_ids(actual.begin(), actual.end());
+        sort(expected_ids.begin(), expected_ids.end());
+        sort(actual_ids.begin(), actual_ids.end());
+        ASSERT_EQUAL(actual_ids, expected_ids);
+        for (const string& query : queries) {
+            for (const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::BANNED }) {
+                const auto expected_found = expected.FindTopDocuments(query, status);
+                const auto found = actual.FindTopDocuments(query, status);
+                ASSERT_EQUAL(found.size(), expected_found.size());
+                for (size_t i = 0; i < found.size(); ++i) {
+                    ASSERT_EQUAL(found[i].id, expected_found[i].id);
+                    ASSERT_EQUAL(found[i].relevance, expected_found[i].relevance);
+                    ASSERT_EQUAL(found[i].rating, expected_found[i].rating);
+                }
+            }
+            for (const int document_id : expected_ids) {
+                const auto [expected_words, expected_status] = expected.MatchDocument(query, document_id);
+                const auto [actual_words, actual_status] = actual.MatchDocument(query, document_id);
+                ASSERT_EQUAL(actual_words, expected_words);
+                ASSERT(actual_status == expected_status);
+            }
+        }
+        for (const int document_id : expected_ids) {
+            ASSERT_EQUAL(actual.GetWordFrequencies(document_id), expected.GetWordFrequencies(document_id));
+        }
+    };
+    check(original, loaded);
+    ASSERT(loaded.FindTopDocuments("starling"s).empty());
+
+    // Загруженный индекс меняется так же, как исходный
+    for (SearchServer* server : { &original, &loaded }) {
+        server->AddDocument(1000, "starling cat and fish"s, DocumentStatus::ACTUAL, { 7 });
+        server->RemoveDocument(3);
+        server->RemoveDocument(30);
+        server->AddDocument(3, "black starling"s, DocumentStatus::ACTUAL, { 2 });
+        server->Compact();
+        server->WaitForMerges();
+    }
+    check(original, loaded);
+
+    // Повреждённые файлы отвергаются, и сервер остаётся прежним
+    string bytes;
+    {
+        ifstream in(path, ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    const string corrupted_path = path + ".corrupted"s;
+    const auto try_load = [&](const string& content, bool verify_checksums) {
+        {
+            ofstream out(corrupted_path, ios::binary | ios::trunc);
+            out.write(content.data(), content.size());
+        }
+        try {
+            loaded.Load(corrupted_path, verify_checksums);
+            return true;
+        }
+        catch (const runtime_error&) {
+            return false;
+        }
+    };
+    string corrupted = bytes;
+    corrupted[corrupted.size() - 3] ^= 0x5A;
+    ASSERT(!try_load(corrupted, true));
+    corrupted = bytes;
+    corrupted[0] = 'X';
+    ASSERT(!try_load(corrupted, false));
+    ASSERT(!try_load(bytes.substr(0, bytes.size() / 2), false));
+    ASSERT(!try_load(string(), false));
+
+    // Смещения слов и блоков проверяются и без контрольных сумм. Раздел ищется по таблице разделов:
+    // заголовок 40 байт, затем записи по 32 байта (id, резерв, смещение, размер, контрольная сумма)
+    const auto read_u64 = [&](size_t offset) {
+        uint64_t value;
+        memcpy(&value, bytes.data() + offset, sizeof(value));
+        return value;
+    };
+    const auto find_section = [&](IndexSection id) {
+        uint32_t section_count;
+        memcpy(&section_count, bytes.data() + 16, sizeof(section_count));
+        for (uint32_t i = 0; i < section_count; ++i) {
+            uint32_t section_id;
+            memcpy(&section_id, bytes.data() + 40 + 32 * i, sizeof(section_id));
+            if (section_id == static_cast<uint32_t>(id)) {
+                return static_cast<size_t>(read_u64(40 + 32 * i + 8));
+            }
+        }
+        return size_t(0);
+    };
+    const auto write_u32 = [](string& content, size_t offset, uint32_t value) {
+        memcpy(content.data() + offset, &value, sizeof(value));
+    };
+    const size_t dictionary = find_section(IndexSection::DICTIONARY);
+    corrupted = bytes;
+    write_u32(corrupted, dictionary + 24 + 8, 0x7FFFFFFF);
+    ASSERT(!try_load(corrupted, false));
+    const size_t postings = find_section(IndexSection::POSTINGS);
+    const size_t blocks = postings + 32 + 48 * read_u64(postings) + (4 * read_u64(postings + 8) + 7) / 8 * 8;
+    corrupted = bytes;
+    write_u32(corrupted, blocks + 8, 0x7FFFFFFF);
+    ASSERT(!try_load(corrupted, false));
+    check(original, loaded);
+
+    const vector<string_view> mapped_words = get<0>(loaded.MatchDocument("fluffy cat"s, 1000));
+    ASSERT_EQUAL(mapped_words, (vector<string_view>{ "cat"sv }));
+    ASSERT(try_load(bytes, true));
+    ASSERT_EQUAL(mapped_words, (vector<string_view>{ "cat"sv }));
+    SearchServer reloaded;
+    reloaded.Load(path);
+    check(reloaded, loaded);
+    // Сохранение поверх своего же файла не портит отображённый индекс
+    reloaded.Save(path);
+    check(reloaded, loaded);
+    filesystem::remove(path);
+    filesystem::remove(corrupted_path);
+}
+
+// Тест проверяет, журнал изменений. Сервер, восстановленный из снимка и журнала, совпадает с исходным, оборванный хвост журнала отбрасывается
+void TestWriteAheadLog() {
+    using namespace std;
+
+    const filesystem::path directory = filesystem::temp_directory_path();
+    const string snapshot_path = (directory / "search_server_test.snapshot"s).string();
+    const string log_path = (directory / "search_server_test.log"s).string();
+    // Снимки пишутся в файлы snapshot_path.N
+    const auto find_snapshots = [&]() {
+        vector<string> names;
+        for (const auto& entry : filesystem::directory_iterator(directory)) {
+            const string name = entry.path().filename().string();
+            if (name.rfind("search_server_test.snapshot"s, 0) == 0) {
+                names.push_back(name);
+            }
+        }
+        sort(names.begin(), names.end());
+        return names;
+    };
+    const auto remove_snapshots = [&]() {
+        for (const string& name : find_snapshots()) {
+            filesystem::remove(directory / name);
+        }
+    };
+    remove_snapshots();
+    filesystem::remove(log_path);
+
+    const vector<string> words = { "cat"s, "dog"s, "bird"s, "fish"s, "tail"s, "ears"s, "collar"s, "fluffy"s, "groomed"s, "black"s, "and"s };
+    mt19937 generator(31);
+    const auto make_text = [&]() {
+        string text;
+        const int length = uniform_int_distribution<int>(1, 8)(generator);
+        for (int i = 0; i < length; ++i) {
+            text += words[uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)] + " "s;
+        }
+        return text;
+    };
+    const vector<string> queries = { "cat"s, "fluffy cat -dog"s, "bird fish tail ears -collar -black"s, "groomed collar and"s };
+    const auto check = [&](const SearchServer& expected, const SearchServer& actual) {
+        ASSERT_EQUAL(actual.GetDocumentCount(), expected.GetDocumentCount());
+        for (const string& query : queries) {
+            const auto expected_found = expected.FindTopDocuments(query, DocumentStatus::ACTUAL, 50);
+            const auto found = actual.FindTopDocuments(query, DocumentStatus::ACTUAL, 50);
+            ASSERT_EQUAL(found.size(), expected_found.size());
+            for (size_t i = 0; i < found.size(); ++i) {
+                ASSERT_EQUAL(found[i].id, expected_found[i].id);
+                ASSERT_EQUAL(found[i].relevance, expected_found[i].relevance);
+                ASSERT_EQUAL(found[i].rating, expected_found[i].rating);
+            }
+        }
+    };
+
+    WriteAheadLogOptions options;
+    options.sync_batch_records = 16;
+    options.sync_interval = chrono::milliseconds(0);
+
+    SearchServer reference;
+    const auto apply_changes = [&](SearchServer& server, int first_id, int last_id) {
+        for (int document_id = first_id; document_id < last_id; ++document_id) {
+            server.AddDocument(document_id, make_text(), DocumentStatus::ACTUAL, { document_id });
+        }
+        for (int document_id = first_id; document_id < last_id; document_id += 5) {
+            server.RemoveDocument(document_id);
+        }
+    };
+    {
+        SearchServer server;
+        server.Recover(snapshot_path, log_path, options);
+        for (SearchServer* target : { &server, &reference }) {
+            target->SetStopWords("and"s);
+        }
+        const auto state = generator;
+        apply_changes(server, 0, 40);
+        generator = state;
+        apply_changes(reference, 0, 40);
+
+        // Пакет пишется в файл, только когда заполнится
+        const auto log_size = filesystem::file_size(log_path);
+        server.AddDocument(1000, "starling"s, DocumentStatus::ACTUAL, {});
+        ASSERT_EQUAL(filesystem::file_size(log_path), log_size);
+        server.SyncWriteAheadLog();
+        ASSERT(filesystem::file_size(log_path) > log_size);
+        server.RemoveDocument(1000);
+        server.SyncWriteAheadLog();
+
+        try {
+            server.Load(snapshot_path);
+            ASSERT_HINT(false, "Load must be rejected while the log is open"s);
+        }
+        catch (const logic_error&) {
+        }
+    }
+    // Оборванная последняя запись отбрасывается
+    {
+        ofstream out(log_path, ios::binary | ios::app);
+        out.write("\x30\x00\x00\x00\x12\x34", 6);
+    }
+    {
+        SearchServer recovered;
+        recovered.Recover(snapshot_path, log_path, options);
+        check(reference, recovered);
+
+        recovered.Checkpoint();
+        ASSERT_EQUAL(filesystem::file_size(log_path), 0u);
+        ASSERT_EQUAL(find_snapshots(), vector<string>{ "search_server_test.snapshot.1"s });
+        const auto state = generator;
+        apply_changes(recovered, 40, 80);
+        generator = state;
+        apply_changes(reference, 40, 80);
+    }
+    string log_after_checkpoint;
+    {
+        ifstream in(log_path, ios::binary);
+        log_after_checkpoint.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    }
+    {
+        SearchServer recovered;
+        recovered.Recover(snapshot_path, log_path, options);
+        check(reference, recovered);
+        // Новый снимок не заменяет отображённый в память, а пишется рядом, прежний удаляется
+        recovered.Checkpoint();
+        ASSERT_EQUAL(find_snapshots(), vector<string>{ "search_server_test.snapshot.2"s });
+        check(reference, recovered);
+    }
+    // Сбой между записью снимка и очисткой журнала: записи, уже вошедшие в снимок, не проигрываются повторно
+    {
+        ofstream out(log_path, ios::binary | ios::trunc);
+        out.write(log_after_checkpoint.data(), log_after_checkpoint.size());
+    }
+    {
+        SearchServer recovered;
+        recovered.Recover(snapshot_path, log_path, options);
+        check(reference, recovered);
+        recovered.AddDocument(2000, "fluffy starling"s, DocumentStatus::ACTUAL, { 3 });
+        reference.AddDocument(2000, "fluffy starling"s, DocumentStatus::ACTUAL, { 3 });
+    }
+    {
+        SearchServer recovered;
+        recovered.Recover(snapshot_path, log_path, options);
+        check(reference, recovered);
+    }
+
+    // Снимок без номера восстанавливается и заменяется нумерованным при контрольной точке
+    remove_snapshots();
+    filesystem::remove(log_path);
+    reference.Save(snapshot_path);
+    {
+        SearchServer recovered;
+        recovered.Recover(snapshot_path, log_path, options);
+        check(reference, recovered);
+        recovered.Checkpoint();
+        ASSERT_EQUAL(find_snapshots(), vector<string>{ "search_server_test.snapshot.1"s });
+    }
+
+    // Неполный пакет сбрасывает фоновый поток
+    remove_snapshots();
+    filesystem::remove(log_path);
+    {
+        SearchServer server;
+        server.Recover(snapshot_path, log_path);
+        server.AddDocument(1, "cat"s, DocumentStatus::ACTUAL, {});
+        for (int attempt = 0; attempt < 500 && filesystem::file_size(log_path) == 0; ++attempt) {
+            this_thread::sleep_for(chrono::milliseconds(10));
+        }
+        ASSERT(filesystem::file_size(log_path) > 0);
+    }
+
+    ASSERT_EQUAL(ComputeCrc32("123456789", 9), 0xCBF43926u);
+    remove_snapshots();
+    filesystem::remove(log_path);
+}
+
+// Тест проверяет, пакетное добавление документов. Результат совпадает с добавлением по одному, ошибочный пакет не добавляется целиком
+void TestAddDocuments() {
+    using namespace std;
+
+    const vector<string> words = { "cat"s, "dog"s, "bird"s, "fish"s, "tail"s, "ears"s, "collar"s, "fluffy"s, "groomed"s, "black"s, "and"s, "with"s };
+    mt19937 generator(37);
+    vector<string> texts;
+    for (int document_id = 0; document_id < 1000; ++document_id) {
+        string text;
+        const int length = uniform_int_distribution<int>(0, 10)(generator);
+        for (int i = 0; i < length; ++i) {
+            text += words[uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)] + (i % 3 == 0 ? "\t"s : " "s);
+        }
+        texts.push_back(text);
+    }
+    vector<NewDocument> batch;
+    for (int document_id = 0; document_id < static_cast<int>(texts.size()); ++document_id) {
+        batch.push_back({ document_id * 2, texts[document_id], document_id % 5 == 0 ? DocumentStatus::BANNED : DocumentStatus::ACTUAL, { document_id * 3, -3, 6 } });
+    }
+
+    // Пакеты добавляются и через сегмент записи, и отдельными сегментами
+    for (const int write_segment_capacity : { DEFAULT_WRITE_SEGMENT_CAPACITY, 100 }) {
+        SearchServer reference("and with"s);
+        SearchServer server("and with"s);
+        server.SetRemovalMode(RemovalMode::TOMBSTONE, 1000);
+        server.SetSegmentPolicy(write_segment_capacity);
+        reference.SetRemovalMode(RemovalMode::TOMBSTONE, 1000);
+        for (const NewDocument& document : batch) {
+            reference.AddDocument(document.id, document.text, document.status, document.ratings);
+        }
+        server.AddDocuments(batch);
+        // Пакет не меньше сегмента записи ложится в запечатанные сегменты, меньший - в сегмент записи
+        ASSERT_EQUAL(server.GetSegmentCount() > 1, write_segment_capacity <= static_cast<int>(batch.size()));
+
+        const vector<string> queries = { "cat"s, "fluffy cat -dog"s, "bird fish tail ears -collar -black"s, "groomed collar and"s };
+        const auto check = [&]() {
+            ASSERT_EQUAL(server.GetDocumentCount(), reference.GetDocumentCount());
+            for (const string& query : queries) {
+                for (const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::BANNED }) {
+                    const auto expected = reference.FindTopDocuments(query, status, 100);
+                    const auto found = server.FindTopDocuments(query, status, 100);
+                    ASSERT_EQUAL(found.size(), expected.size());
+                    for (size_t i = 0; i < found.size(); ++i) {
+                        ASSERT_EQUAL(found[i].id, expected[i].id);
+                        ASSERT_EQUAL(found[i].relevance, expected[i].relevance);
+                        ASSERT_EQUAL(found[i].rating, expected[i].rating);
+                    }
+                }
+            }
+            for (const int document_id : reference) {
+                ASSERT_EQUAL(server.GetWordFrequencies(document_id), reference.GetWordFrequencies(document_id));
+            }
+        };
+        check();
+
+        // Удалённые id можно добавить пакетом снова
+        vector<NewDocument> second_batch;
+        for (int document_id = 0; document_id < 100; document_id += 4) {
+            reference.RemoveDocument(document_id);
+            server.RemoveDocument(document_id);
+            second_batch.push_back({ document_id, "starling with fluffy tail"sv, DocumentStatus::ACTUAL, { -document_id } });
+        }
+        second_batch.push_back({ 5001, ""sv, DocumentStatus::ACTUAL, { 1 } });
+        for (const NewDocument& document : second_batch) {
+            reference.AddDocument(document.id, document.text, document.status, document.ratings);
+        }
+        server.AddDocuments(second_batch);
+        check();
+
+        // Ошибки те же, что у AddDocument, и пакет с ошибкой не добавляется
+        const auto expect_error = [&](const vector<NewDocument>& bad_batch, const string& document_text, int document_id) {
+            string expected_message;
+            try {
+                reference.AddDocument(document_id, document_text, DocumentStatus::ACTUAL, {});
+            }
+            catch (const invalid_argument& e) {
+                expected_message = e.what();
+            }
+            ASSERT(!expected_message.empty());
+            const int count = server.GetDocumentCount();
+            try {
+                server.AddDocuments(bad_batch);
+                ASSERT_HINT(false, "Bad batch must be rejected"s);
+            }
+            catch (const invalid_argument& e) {
+                ASSERT_EQUAL(string(e.what()), expected_message);
+            }
+            ASSERT_EQUAL(server.GetDocumentCount(), count);
+            ASSERT(server.FindTopDocuments("parrot"s).empty());
+        };
+        expect_error({ { 7001, "parrot"s, DocumentStatus::ACTUAL, { 1 } }, { -1, "parrot"s, DocumentStatus::ACTUAL, { 1 } } }, "parrot"s, -1);
+        expect_error({ { 7001, "parrot"s, DocumentStatus::ACTUAL, { 1 } }, { 2, "parrot"s, DocumentStatus::ACTUAL, { 1 } } }, "parrot"s, 2);
+        expect_error({ { 7001, "parrot"s, DocumentStatus::ACTUAL, { 1 } }, { 7002, "parrot in\x12 cage"s, DocumentStatus::ACTUAL, { 1 } } }, "parrot in\x12 cage"s, 7002);
+        expect_error({ { 7001, "parrot"s, DocumentStatus::ACTUAL, { 1 } }, { 7001, "parrot"s, DocumentStatus::ACTUAL, { 1 } } }, "parrot"s, 2);
+        // Первая ошибка пакета определяет исключение
+        expect_error({ { 7001, "bad\x01"s, DocumentStatus::ACTUAL, { 1 } }, { -5, "parrot"s, DocumentStatus::ACTUAL, { 1 } } }, "bad\x01"s, 7001);
+
+        server.AddDocuments({});
+        check();
+        server.WaitForMerges();
+        check();
+    }
+}
+
+void TestRemoveDuplicates() {
+    using namespace std;
+
+    // Удаляет дубликаты, перехватывая вывод, и возвращает его
+    const auto remove_duplicates = [](SearchServer& server) {
+        ostringstream output;
+        streambuf* const cout_buffer = cout.rdbuf(output.rdbuf());
+        RemoveDuplicates(server);
+        cout.rdbuf(cout_buffer);
+        return output.str();
+    };
+
+    {
+        SearchServer server("and with"s);
+        server.AddDocument(1, "funny pet and nasty rat"s, DocumentStatus::ACTUAL, { 7, 2, 7 });
+        server.AddDocument(2, "funny pet with curly hair"s, DocumentStatus::ACTUAL, { 1, 2 });
+        server.AddDocument(3, "funny pet with curly hair"s, DocumentStatus::ACTUAL, { 1, 2 });
+        server.AddDocument(4, "funny pet and curly hair"s, DocumentStatus::ACTUAL, { 1, 2 });
+        server.AddDocument(5, "funny funny pet and nasty nasty rat"s, DocumentStatus::BANNED, { 1, 2 });
+        server.AddDocument(6, "funny pet and not very nasty rat"s, DocumentStatus::ACTUAL, { 1, 2 });
+        server.AddDocument(7, "very nasty rat and not very funny pet"s, DocumentStatus::ACTUAL, { 1, 2 });
+        server.AddDocument(8, "pet with rat and rat and rat"s, DocumentStatus::ACTUAL, { 1, 2 });
+        server.AddDocument(9, "nasty rat with curly hair"s, DocumentStatus::ACTUAL, { 1, 2 });
+        // Документы из одних стоп-слов - дубликаты друг друга
+        server.AddDocument(10, "and with"s, DocumentStatus::ACTUAL, {});
+        server.AddDocument(11, "with"s, DocumentStatus::ACTUAL, {});
+        ASSERT_EQUAL(remove_duplicates(server), "Found duplicate document id 3\nFound duplicate document id 4\nFound duplicate document id 5\n"
+            "Found duplicate document id 7\nFound duplicate document id 11\n"s);
+        ASSERT_EQUAL(vector<int>(server.begin(), server.end()), vector<int>({ 1, 2, 6, 8, 9, 10 }));
+        ASSERT(remove_duplicates(server).empty());
+    }
+
+    // Результат совпадает с попарным сравнением наборов слов
+    const vector<string> words = { "cat"s, "dog"s, "bird"s, "fish"s, "tail"s, "and"s };
+    mt19937 generator(47);
+    SearchServer server("and"s);
+    map<int, string> texts;
+    for (int document_id = 300; document_id > 0; --document_id) {
+        string text;
+        const int length = uniform_int_distribution<int>(0, 4)(generator);
+        for (int i = 0; i < length; ++i) {
+            text += words[uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)] + " "s;
+        }
+        server.AddDocument(document_id * 3, text, DocumentStatus::ACTUAL, {});
+        texts[document_id * 3] = text;
+    }
+    set<int> expected;
+    const vector<int> document_ids(server.begin(), server.end());
+    for (size_t i = 0; i < document_ids.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            const auto& lhs = server.GetWordFrequencies(document_ids[j]);
+            const auto& rhs = server.GetWordFrequencies(document_ids[i]);
+            if (lhs.size() == rhs.size() && equal(lhs.begin(), lhs.end(), rhs.begin(), [](const auto& l, const auto& r) { return l.first == r.first; })) {
+                expected.insert(document_ids[i]);
+                break;
+            }
+        }
+    }
+    ASSERT(!expected.empty());
+    // Пакетное удаление, в том числе из запечатанных сегментов, совпадает с удалением по одному
+    server.SealWriteSegment();
+    SearchServer removed_one_by_one("and"s);
+    for (const auto& [document_id, text] : texts) {
+        removed_one_by_one.AddDocument(document_id, text, DocumentStatus::ACTUAL, {});
+    }
+    for (const int document_id : expected) {
+        removed_one_by_one.RemoveDocument(document_id);
+    }
+    remove_duplicates(server);
+    // Рейтинги одинаковы, поэтому порядок документов с равной релевантностью не определён и сравниваются наборы
+    const auto find_all = [](const SearchServer& search_server, const string& query) {
+        map<int, double> found;
+        for (const Document& document : search_server.FindTopDocuments(query, DocumentStatus::ACTUAL, 1000)) {
+            found[document.id] = document.relevance;
+        }
+        return found;
+    };
+    for (const string& query : words) {
+        ASSERT_EQUAL(find_all(server, query), find_all(removed_one_by_one, query));
+    }
+    vector<int> remaining;
+    copy_if(document_ids.begin(), document_ids.end(), back_inserter(remaining), [&expected](int document_id) {
+        return expected.count(document_id) == 0;
+    });
+    ASSERT_EQUAL(vector<int>(server.begin(), server.end()), remaining);
+}
+
+void TestNearDuplicates() {
+    using namespace std;
+
+    // Основы - случайные наборы из 30 разных слов. Копия заменяет в основе 1-2 слова (сходство не ниже 0.88),
+    // а разные основы почти не пересекаются
+    vector<string> vocabulary;
+    for (int i = 0; i < 3000; ++i) {
+        vocabulary.push_back("w"s + to_string(i));
+    }
+    mt19937 generator(53);
+    const auto make_base = [&]() {
+        vector<string> words = vocabulary;
+        shuffle(words.begin(), words.end(), generator);
+        words.resize(30);
+        return words;
+    };
+    const auto join = [](const vector<string>& words) {
+        string text;
+        for (const string& word : words) {
+            text += word + " "s;
+        }
+        return text;
+    };
+
+    SearchServer server;
+    vector<vector<int>> expected;
+    int next_id = 1;
+    for (int base_number = 0; base_number < 200; ++base_number) {
+        const vector<string> base = make_base();
+        server.AddDocument(next_id, join(base), DocumentStatus::ACTUAL, {});
+        vector<int> group = { next_id++ };
+        const int copy_count = base_number % 3;
+        for (int copy = 0; copy < copy_count; ++copy) {
+            vector<string> words = base;
+            for (int change = 0; change <= copy; ++change) {
+                words[uniform_int_distribution<int>(0, 29)(generator)] = "new"s + to_string(next_id) + "x"s + to_string(change);
+            }
+            // Порядок и повторы слов не влияют на набор
+            reverse(words.begin(), words.end());
+            words.push_back(words.front());
+            server.AddDocument(next_id, join(words), DocumentStatus::ACTUAL, {});
+            group.push_back(next_id++);
+        }
+        if (group.size() > 1) {
+            expected.push_back(group);
+        }
+    }
+    server.SealWriteSegment();
+    const auto check_groups = [&expected](const vector<vector<int>>& groups) {
+        ASSERT_EQUAL(groups.size(), expected.size());
+        for (size_t i = 0; i < groups.size(); ++i) {
+            ASSERT_EQUAL(groups[i], expected[i]);
+        }
+    };
+    check_groups(FindNearDuplicates(server, { 0.8 }));
+    // Порог 1 оставляет только точные совпадения наборов слов
+    ASSERT(FindNearDuplicates(server, { 1.0 }).empty());
+    check_groups(FindNearDuplicates(server, { 0.8, 64, 16 }));
+
+    for (const NearDuplicateOptions& bad : { NearDuplicateOptions{ 1.5 }, NearDuplicateOptions{ 0.8, 0, 1 }, NearDuplicateOptions{ 0.8, 100, 32 } }) {
+        try {
+            FindNearDuplicates(server, bad);
+            ASSERT_HINT(false, "Bad options must be rejected"s);
+        }
+        catch (const invalid_argument&) {
+        }
+    }
+
+    // Из каждой группы остаётся документ с наименьшим id, группы выводятся
+    ostringstream output;
+    streambuf* const cout_buffer = cout.rdbuf(output.rdbuf());
+    RemoveNearDuplicates(server);
+    cout.rdbuf(cout_buffer);
+    ostringstream expected_output;
+    set<int> removed;
+    for (const vector<int>& group : expected) {
+        expected_output << "Found near-duplicate documents"s;
+        for (const int document_id : group) {
+            expected_output << ' ' << document_id;
+        }
+        expected_output << '\n';
+        removed.insert(group.begin() + 1, group.end());
+    }
+    ASSERT_EQUAL(output.str(), expected_output.str());
+    ASSERT_EQUAL(server.GetDocumentCount(), next_id - 1 - static_cast<int>(removed.size()));
+    for (const int document_id : removed) {
+        ASSERT(server.GetWordFrequencies(document_id).empty());
+    }
+    ASSERT(FindNearDuplicates(server).empty());
+
+    // Цепочка: 1~2 и 2~3 (сходство 9/11), но 1 и 3 не похожи (8/12). Удаляется только копия, похожая
+    // на представителя группы, а документ 3 остаётся
+    SearchServer chain;
+    vector<string> words(12);
+    for (int i = 0; i < 12; ++i) {
+        words[i] = "c"s + to_string(i);
+    }
+    for (int id = 1; id <= 3; ++id) {
+        chain.AddDocument(id, join({ words.begin() + id - 1, words.begin() + id + 9 }), DocumentStatus::ACTUAL, {});
+    }
+    const vector<vector<int>> chain_groups = FindNearDuplicates(chain);
+    ASSERT_EQUAL(chain_groups.size(), 1u);
+    ASSERT_EQUAL(chain_groups[0], vector<int>({ 1, 2 }));
+    streambuf* const chain_cout_buffer = cout.rdbuf(output.rdbuf());
+    RemoveNearDuplicates(chain);
+    cout.rdbuf(chain_cout_buffer);
+    ASSERT_EQUAL(vector<int>(chain.begin(), chain.end()), vector<int>({ 1, 3 }));
+
+    // Длинная цепочка делится на пары соседей, представитель сравнивается только со своими кандидатами
+    SearchServer long_chain;
+    const int chain_length = 3000;
+    for (int id = 1; id <= chain_length; ++id) {
+        string text;
+        for (int word = id - 1; word < id + 9; ++word) {
+            text += "c"s + to_string(word) + " "s;
+        }
+        long_chain.AddDocument(id, text, DocumentStatus::ACTUAL, {});
+    }
+    const vector<vector<int>> long_chain_groups = FindNearDuplicates(long_chain);
+    ASSERT_EQUAL(long_chain_groups.size(), static_cast<size_t>(chain_length / 2));
+    for (size_t i = 0; i < long_chain_groups.size(); ++i) {
+        const int first_id = static_cast<int>(2 * i + 1);
+        ASSERT_EQUAL(long_chain_groups[i], vector<int>({ first_id, first_id + 1 }));
+    }
+}
+
+void TestSplitIntoWords() {
+    using namespace std;
+
+    // Разбор поиском разделителей и проверка слов посимвольно, как до векторного разбора
+    const auto reference_split = [](string_view text) {
+        vector<string_view> words;
+        const string_view delimiters = " \r\n\t\v"sv;
+        size_t begin = text.find_first_not_of(delimiters);
+        while (begin != string_view::npos) {
+            const size_t end = min(text.find_first_of(delimiters, begin), text.size());
+            words.push_back(text.substr(begin, end - begin));
+            begin = text.find_first_not_of(delimiters, end);
+        }
+        return words;
+    };
+    const auto reference_is_valid = [](string_view word) {
+        for (size_t i = 0; i < word.size(); ++i) {
+            const char c = word[i];
+            const bool is_valid = c < 0 || (!iscntrl(c) && (i == 0 ? isalpha(c) : isgraph(c)));
+            if (!is_valid) {
+                return false;
+            }
+        }
+        return !word.empty();
+    };
+
+    ASSERT_EQUAL(SplitIntoWords(""sv), vector<string_view>());
+    ASSERT_EQUAL(SplitIntoWords(" \t\r\n\v "sv), vector<string_view>());
+    ASSERT_EQUAL(SplitIntoWords("cat"sv), vector<string_view>({ "cat"sv }));
+    ASSERT_EQUAL(SplitIntoWords("  cat\tdog\r\n-bird  "sv), vector<string_view>({ "cat"sv, "dog"sv, "-bird"sv }));
+    vector<string_view> words;
+    ASSERT(SplitIntoValidWords("пушистый кот x-1"sv, words));
+    ASSERT_EQUAL(words, vector<string_view>({ "пушистый"sv, "кот"sv, "x-1"sv }));
+    for (const string_view bad : { "1cat"sv, "-cat"sv, "ca\x01t"sv, "cat\f"sv, "c\x7f"sv, "cat dog _"sv }) {
+        words.clear();
+        ASSERT_HINT(!SplitIntoValidWords(bad, words), string(bad));
+    }
+    ASSERT(IsValidWord("cat-1"sv) && IsValidWord("\xd0\xba"sv));
+    ASSERT(!IsValidWord(""sv) && !IsValidWord("1"sv) && !IsValidWord("ca t"sv) && !IsValidWord("ca\x1bt"sv));
+
+    // Случайные тексты разной длины покрывают границы блоков и все классы символов
+    const string alphabet = "abcXYZ019-_.~ \t\n\v\r\f\x01\x1f\x7f\x80\xd0\xff"s;
+    mt19937 generator(43);
+    for (int i = 0; i < 20000; ++i) {
+        string text;
+        const int length = uniform_int_distribution<int>(0, 100)(generator);
+        // В большинстве текстов только буквы и пробелы, чтобы были и верные тексты
+        const int alphabet_size = i % 4 == 0 ? static_cast<int>(alphabet.size()) : 4;
+        for (int j = 0; j < length; ++j) {
+            const int k = uniform_int_distribution<int>(0, alphabet_size - 1)(generator);
+            text += alphabet_size == 4 ? "ab \xd0"[k] : alphabet[k];
+        }
+        const vector<string_view> expected = reference_split(text);
+        ASSERT_EQUAL(SplitIntoWords(text), expected);
+        const bool expected_valid = all_of(expected.begin(), expected.end(), reference_is_valid);
+        words.clear();
+        ASSERT_EQUAL(SplitIntoValidWords(text, words), expected_valid);
+        if (expected_valid) {
+            ASSERT_EQUAL(words, expected);
+        }
+        for (const string_view word : expected) {
+            ASSERT_EQUAL(IsValidWord(word), reference_is_valid(word));
+        }
+    }
+}
+
+void TestIngestCorpus() {
+    using namespace std;
+
+    const string path = (filesystem::temp_directory_path() / "search_server_test.corpus"s).string();
+    const auto write_corpus = [&path](const string& content) {
+        ofstream out(path, ios::binary | ios::trunc);
+        out << content;
+    };
+
+    const vector<string> words = { "cat"s, "dog"s, "bird"s, "fish"s, "tail"s, "ears"s, "collar"s, "fluffy"s, "and"s };
+    const vector<string> statuses = { "ACTUAL"s, "BANNED"s, "2"s, "IRRELEVANT"s };
+    mt19937 generator(41);
+    string corpus;
+    SearchServer reference("and"s);
+    for (int document_id = 0; document_id < 500; ++document_id) {
+        // Одна строка длиннее блока чтения
+        const int length = document_id == 123 ? 300 : uniform_int_distribution<int>(0, 8)(generator);
+        string text;
+        for (int i = 0; i < length; ++i) {
+            text += (i > 0 ? " "s : ""s) + words[uniform_int_distribution<int>(0, static_cast<int>(words.size()) - 1)(generator)];
+        }
+        vector<int> ratings;
+        string ratings_text;
+        for (int i = 0; i < document_id % 3; ++i) {
+            ratings.push_back(document_id * 3 - i);
+            ratings_text += (i > 0 ? " "s : ""s) + to_string(ratings.back());
+        }
+        const string& status = statuses[document_id % statuses.size()];
+        const DocumentStatus document_status = ParseCorpusLine("0\t"s + status + "\t\t"s).status;
+        corpus += to_string(document_id * 2) + "\t"s + status + "\t"s + ratings_text + "\t"s + text + (document_id % 7 == 0 ? "\r\n"s : "\n"s);
+        if (document_id % 50 == 0) {
+            corpus += "\n"s;
+        }
+        reference.AddDocument(document_id * 2, text, document_status, ratings);
+    }
+    // Последняя строка без перевода строки
+    corpus += "5000\tACTUAL\t7\tfluffy parrot"s;
+    reference.AddDocument(5000, "fluffy parrot"s, DocumentStatus::ACTUAL, { 7 });
+    write_corpus(corpus);
+
+    for (const size_t block_size : { size_t(256), size_t(1) << 20 }) {
+        SearchServer server("and"s);
+        IngestionOptions options;
+        options.block_size = block_size;
+        options.queue_capacity = 2;
+        ASSERT_EQUAL(IngestCorpus(server, path, options), reference.GetDocumentCount());
+        ASSERT_EQUAL(server.GetDocumentCount(), reference.GetDocumentCount());
+        for (const int document_id : reference) {
+            ASSERT_EQUAL(server.GetWordFrequencies(document_id), reference.GetWordFrequencies(document_id));
+        }
+        for (const string& query : { "cat"s, "fluffy -dog"s, "bird fish tail -collar"s, "parrot"s }) {
+            for (const DocumentStatus status : { DocumentStatus::ACTUAL, DocumentStatus::BANNED, DocumentStatus::REMOVED, DocumentStatus::IRRELEVANT }) {
+                const auto expected = reference.FindTopDocuments(query, status, 1000);
+                const auto found = server.FindTopDocuments(query, status, 1000);
+                ASSERT_EQUAL(found.size(), expected.size());
+                for (size_t i = 0; i < found.size(); ++i) {
+                    ASSERT_EQUAL(found[i].id, expected[i].id);
+                    ASSERT_EQUAL(found[i].relevance, expected[i].relevance);
+                    ASSERT_EQUAL(found[i].rating, expected[i].rating);
+                }
+            }
+        }
+    }
+
+    // Неверная строка прерывает загрузку, блоки до неё остаются в сервере
+    const auto expect_error = [&](const string& content, const string& expected_message) {
+        write_corpus(content);
+        SearchServer server;
+        try {
+            IngestCorpus(server, path);
+            ASSERT_HINT(false, "Bad corpus must be rejected"s);
+        }
+        catch (const invalid_argument& e) {
+            if (!expected_message.empty()) {
+                ASSERT_EQUAL(string(e.what()), expected_message);
+            }
+        }
+        ASSERT(server.FindTopDocuments("parrot"s).empty());
+    };
+    expect_error("1\tACTUAL\t\tcat\n2\tACTUAL\tcat\n"s, "Bad corpus line 2"s);
+    expect_error("1\tACTUAL\t\tcat\n\n2\tSOLD\t\tcat\n"s, "Bad corpus line 3"s);
+    expect_error("1\tACTUAL\t1 x\tcat\n"s, "Bad corpus line 1"s);
+    expect_error("x1\tACTUAL\t\tcat\n"s, "Bad corpus line 1"s);
+    expect_error("1\t7\t\tcat\n"s, "Bad corpus line 1"s);
+    // Ошибки документов те же, что у AddDocuments
+    expect_error("1\tACTUAL\t\tparrot\n1\tACTUAL\t\tparrot\n"s, ""s);
+    expect_error("-1\tACTUAL\t\tparrot\n"s, ""s);
+
+    filesystem::remove(path);
+    SearchServer server;
+    try {
+        IngestCorpus(server, path);
+        ASSERT_HINT(false, "Missing corpus must be rejected"s);
+    }
+    catch (const runtime_error&) {
+    }
+}
+
+// Тест проверяет, что поиск в других потоках видит согласованное состояние индекса, пока писатель добавляет и удаляет документы
+void TestConcurrentReadersAndWriter() {
+    using namespace std;
+
+    const int document_count = 600;
+    for (const RemovalMode mode : { RemovalMode::IMMEDIATE, RemovalMode::TOMBSTONE }) {
+        SearchServer server("and"s);
+        server.SetRemovalMode(mode, 8);
+        server.SetSegmentPolicy(8, 2);
+
+        // Чётные документы остаются навсегда, из нечётных живы не больше двух последних
+        atomic<bool> done = false;
+        thread writer([&]() {
+            for (int document_id = 0; document_id < document_count; ++document_id) {
+                if (document_id % 2 == 0) {
+                    server.AddDocument(document_id, "stable marker and n"s + to_string(document_id), DocumentStatus::ACTUAL, { 1 });
+                }
+                else {
+                    server.AddDocument(document_id, "volatile marker"s, DocumentStatus::ACTUAL, { 2 });
+                    server.RemoveDocument(document_id - 2);
+                }
+            }
+            done = true;
+        });
+
+        vector<thread> readers;
+        for (int i = 0; i < 3; ++i) {
+            readers.emplace_back([&]() {
+                size_t last_stable_count = 0;
+                do {
+                    const auto stable = server.FindTopDocuments("stable"s, DocumentStatus::ACTUAL, document_count);
+                    ASSERT(stable.size() >= last_stable_count);
+                    last_stable_count = stable.size();
+                    for (const Document& document : stable) {
+                        ASSERT_EQUAL(document.id % 2, 0);
+                    }
+
+                    const auto transient = server.FindTopDocuments("marker -stable"s, DocumentStatus::ACTUAL, document_count);
+                    ASSERT(transient.size() <= 2u);
+                    for (const Document& document : transient) {
+                        ASSERT_EQUAL(document.id % 2, 1);
+                    }
+
+                    const auto all = server.FindTopDocuments("marker volatile"s, DocumentStatus::ACTUAL, document_count);
+                    ASSERT(is_sorted(all.begin(), all.end(), [](const Document& lhs, const Document& rhs) {
+                        return lhs.relevance > rhs.relevance + EPSILON;
+                    }));
+
+                    if (!stable.empty()) {
+                        const auto [words, status] = server.MatchDocument("stable marker -volatile"s, stable.front().id);
+                        ASSERT_EQUAL(words, (vector<string_view>{ "marker"sv, "stable"sv }));
+                        ASSERT(status == DocumentStatus::ACTUAL);
+                    }
+                } while (!done);
+            });
+        }
+        writer.join();
+        for (thread& reader : readers) {
+            reader.join();
+        }
+
+        server.WaitForMerges();
+        ASSERT_EQUAL(server.GetDocumentCount(), document_count / 2 + 1);
+        ASSERT_EQUAL(server.FindTopDocuments("stable"s, DocumentStatus::ACTUAL, document_count).size(), static_cast<size_t>(document_count / 2));
+        ASSERT_EQUAL(server.FindTopDocuments("marker -stable"s, DocumentStatus::ACTUAL, document_count).size(), 1u);
+    }
+}
+
 void TestSearchServer() {
     RUN_TEST(TestExcludeStopWordsFromAddedDocumentContent);
     RUN_TEST(TestAddDocument);
@@ -696,4 +2594,28 @@ void TestSearchServer() {
     RUN_TEST(TestLambdaFiltering);
     RUN_TEST(TestFilteringStatus);
     RUN_TEST(TestRelevance);
+    RUN_TEST(TestTermDictionary);
+    RUN_TEST(TestPostingList);
+    RUN_TEST(TestDocumentTable);
+    RUN_TEST(TestRemoveDocument);
+    RUN_TEST(TestTopDocumentsLimit);
+    RUN_TEST(TestScoreAccumulator);
+    RUN_TEST(TestParallelFindTopDocuments);
+    RUN_TEST(TestProcessQueries);
+    RUN_TEST(TestParallelMatchDocument);
+    RUN_TEST(TestStringViewApi);
+    RUN_TEST(TestDynamicPruning);
+    RUN_TEST(TestCorpusStatistics);
+    RUN_TEST(TestResultCache);
+    RUN_TEST(TestQueryPlanCache);
+    RUN_TEST(TestSegmentedIndex);
+    RUN_TEST(TestConcurrentReadersAndWriter);
+    RUN_TEST(TestShardedSearchServer);
+    RUN_TEST(TestIndexFile);
+    RUN_TEST(TestWriteAheadLog);
+    RUN_TEST(TestAddDocuments);
+    RUN_TEST(TestIngestCorpus);
+    RUN_TEST(TestSplitIntoWords);
+    RUN_TEST(TestRemoveDuplicates);
+    RUN_TEST(TestNearDuplicates);
 }
\ No newline at end of file
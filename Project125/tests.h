@@ -2,39 +2,111 @@
 
 #include "tests_framework.h"
 
-//  ,     -   
+// Тест проверяет, что поисковая система исключает стоп-слова при добавлении документов
 void TestExcludeStopWordsFromAddedDocumentContent();
 
-//  ,  .       ,     .
+// Тест проверяет, добавление документов. Добавленный документ должен находиться по поисковому запросу, который содержит слова из документа.
 void TestAddDocument();
 
-//  ,  -. -    .
+// Тест проверяет, поддержку стоп-слов. Стоп-слова исключаются из текста документов.
 void TestExcludeStopWords();
 
-//  ,  -. ,  -  ,      .
+// Тест проверяет, поддержку минус-слов. Документы, содержащие минус-слова поискового запроса, не должны включаться в результаты поиска.
 void TestMinusWords();
 
-//  ,  .        
-//      ,   .   
-//     -,     .
+// Тест проверяет, матчинг документов. При матчинге документа по поисковому запросу должны быть
+// возвращены все слова из поискового запроса, присутствующие в документе. Если есть соответствие
+// хотя бы по одному минус-слову, должен возвращаться пустой список слов.
 void TestMatch();
 
-//  ,     .   
-//         .
+// Тест проверяет, сортировку найденных документов по релевантности. Возвращаемые при поиске
+// документов результаты должны быть отсортированы в порядке убывания релевантности.
 void TestRelevanceSort();
 
-//  ,   .  
-//      .
+// Тест проверяет, вычисление рейтинга документов. Рейтинг добавленного
+// документа равен среднему арифметическому оценок документа.
 void TestRating();
 
-//  ,      ,  .
+// Тест проверяет, фильтрацию результатов поиска с использованием предиката, задаваемого пользователем.
 void TestLambdaFiltering();
 
-//  ,  ,   .
+// Тест проверяет, поиск документов, имеющих заданный статус.
 void TestFilteringStatus();
 
-//  ,     .
+// Тест проверяет, корректное вычисление релевантности найденных документов.
 void TestRelevance();
 
-//  TestSearchServer      
+// Тест проверяет, словарь терминов. Одно и то же слово всегда получает один и тот же идентификатор, а незнакомые слова запроса ничего не находят.
+void TestTermDictionary();
+
+// Тест проверяет, сжатый список вхождений. Вставка в произвольном порядке и удаление сохраняют отсортированный по id список с правильными частотами.
+void TestPostingList();
+
+// Тест проверяет, таблицу документов. Доступ по порядковому номеру идёт в порядке возрастания id, освободившиеся слоты переиспользуются.
+void TestDocumentTable();
+
+// Тест проверяет, удаление документов. Удалённые сразу и помеченные надгробием документы не находятся, а релевантность остальных не меняется.
+void TestRemoveDocument();
+
+// Тест проверяет, отбор лучших документов. Число результатов задаётся при вызове, порядок совпадает с сортировкой по релевантности и рейтингу.
+void TestTopDocumentsLimit();
+
+// Тест проверяет, аккумулятор релевантности. Минус-слова исключают слот, сброс очищает только затронутые слоты, повторные запросы дают тот же результат.
+void TestScoreAccumulator();
+
+// Тест проверяет, параллельный поиск. Результаты с std::execution::par совпадают с последовательным поиском.
+void TestParallelFindTopDocuments();
+
+// Тест проверяет, пакетную обработку запросов. Результаты приходят в порядке запросов и совпадают с последовательным поиском.
+void TestProcessQueries();
+
+// Тест проверяет, параллельный матчинг документа. Результат совпадает с последовательным, найденные слова ссылаются на строки сервера.
+void TestParallelMatchDocument();
+
+// Тест проверяет, что сервер принимает std::string_view и хранит собственные копии слов документа.
+void TestStringViewApi();
+
+// Тест проверяет, поиск с отсечением по верхним оценкам вклада слов. Результаты совпадают с полным перебором.
+void TestDynamicPruning();
+
+// Тест проверяет, статистику корпуса. Документные частоты и IDF обновляются при добавлении и удалении документов.
+void TestCorpusStatistics();
+
+// Тест проверяет, кэш результатов поиска. Повторный запрос берётся из кэша, изменение индекса делает кэш недействительным, редкие запросы не вытесняют частые.
+void TestResultCache();
+
+// Тест проверяет, кэш скомпилированных запросов. Повторный запрос даёт тот же результат, а изменения словаря и стоп-слов учитываются.
+void TestQueryPlanCache();
+
+// Тест проверяет, сегментированный индекс. Поиск по нескольким сегментам совпадает с поиском по одному, слияние убирает удалённые документы.
+void TestSegmentedIndex();
+
+// Тест проверяет, поиск одновременно с изменением индекса. Читатели в других потоках видят документы целиком и не видят удалённых.
+void TestConcurrentReadersAndWriter();
+
+// Тест проверяет, сервер с шардами. Результаты и релевантность совпадают с сервером, в котором лежат все документы.
+void TestShardedSearchServer();
+
+// Тест проверяет, файл индекса. Загруженный из файла сервер ищет так же, как сохранённый, а повреждённый файл отвергается.
+void TestIndexFile();
+
+// Тест проверяет, журнал изменений. Сервер, восстановленный из снимка и журнала, совпадает с исходным, оборванный хвост журнала отбрасывается.
+void TestWriteAheadLog();
+
+// Тест проверяет, пакетное добавление документов. Результат совпадает с добавлением по одному, ошибочный пакет не добавляется целиком.
+void TestAddDocuments();
+
+// Тест проверяет, загрузку корпуса из файла. Результат совпадает с добавлением по одному, неверная строка прерывает загрузку.
+void TestIngestCorpus();
+
+// Тест проверяет, разбор текста на слова. Слова и их проверка совпадают с посимвольным разбором.
+void TestSplitIntoWords();
+
+// Тест проверяет, удаление дубликатов. Из документов с одинаковым набором слов остаётся документ с наименьшим id.
+void TestRemoveDuplicates();
+
+// Тест проверяет, поиск почти одинаковых документов. Копии с небольшими изменениями собираются в группы, разные документы - нет.
+void TestNearDuplicates();
+
+// Функция TestSearchServer является точкой входа для запуска тестов
 void TestSearchServer();
@@ -72,7 +72,7 @@ void AssertEqualImpl(const T& t, const U& u, const std::string& t_str, const std
 template <typename K, typename V>
 void AssertEqualImpl(const std::map<K, V>& t, const std::map<K, V>& u, const std::string& t_str, const std::string& u_str, const std::string& file, const std::string& func, unsigned line, const std::string& hint) {
     using namespace std;
-    if (!equal(t.cbegin(), t.cend(), u.cbegin())) {
+    if (t.size() != u.size() || !equal(t.cbegin(), t.cend(), u.cbegin())) {
         cerr << boolalpha;
         cerr << file << "("s << line << "): "s << func << ": "s;
         cerr << "ASSERT_EQUAL("s << t_str << ", "s << u_str << ") failed: "s;
@@ -88,7 +88,7 @@ void AssertEqualImpl(const std::map<K, V>& t, const std::map<K, V>& u, const std
 template <typename T>
 void AssertEqualImpl(const std::set<T>& t, const std::set<T>& u, const std::string& t_str, const std::string& u_str, const std::string& file, const std::string& func, unsigned line, const std::string& hint) {
     using namespace std;
-    if (!equal(t.cbegin(), t.cend(), u.cbegin())) {
+    if (t.size() != u.size() || !equal(t.cbegin(), t.cend(), u.cbegin())) {
         cerr << boolalpha;
         cerr << file << "("s << line << "): "s << func << ": "s;
         cerr << "ASSERT_EQUAL("s << t_str << ", "s << u_str << ") failed: "s;
@@ -104,7 +104,7 @@ void AssertEqualImpl(const std::set<T>& t, const std::set<T>& u, const std::stri
 template <typename T>
 void AssertEqualImpl(const std::vector<T>& t, const std::vector<T>& u, const std::string& t_str, const std::string& u_str, const std::string& file, const std::string& func, unsigned line, const std::string& hint) {
     using namespace std;
-    if (!equal(t.cbegin(), t.cend(), u.cbegin())) {
+    if (t.size() != u.size() || !equal(t.cbegin(), t.cend(), u.cbegin())) {
         cerr << boolalpha;
         cerr << file << "("s << line << "): "s << func << ": "s;
         cerr << "ASSERT_EQUAL("s << t_str << ", "s << u_str << ") failed: "s;
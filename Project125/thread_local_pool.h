@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+// Пул объектов текущего потока. Lease берёт объект из пула (или создаёт новый)
+// и возвращает его обратно при разрушении, так что объект переживает запрос вместе с выделенной памятью
+template <typename T>
+class ThreadLocalPool {
+public:
+    class Lease {
+    public:
+        Lease() {
+            auto& pool = freeObjects();
+            if (pool.empty()) {
+                object_ = std::make_unique<T>();
+            }
+            else {
+                object_ = std::move(pool.back());
+                pool.pop_back();
+            }
+        }
+
+        ~Lease() {
+            freeObjects().push_back(std::move(object_));
+        }
+
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        T& operator*() const {
+            return *object_;
+        }
+
+        T* operator->() const {
+            return object_.get();
+        }
+
+    private:
+        std::unique_ptr<T> object_;
+    };
+
+private:
+    static std::vector<std::unique_ptr<T>>& freeObjects() {
+        thread_local std::vector<std::unique_ptr<T>> pool;
+        return pool;
+    }
+};
@@ -0,0 +1,63 @@
+#include "top_documents.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "utility.h"
+
+TopDocuments::TopDocuments(int max_count) : max_count_(max_count > 0 ? max_count : 0) {
+    heap_.reserve(max_count_);
+}
+
+void TopDocuments::Reset(int max_count) {
+    max_count_ = max_count > 0 ? max_count : 0;
+    heap_.clear();
+    heap_.reserve(max_count_);
+}
+
+void TopDocuments::Push(const Document& document) {
+    if (heap_.size() < max_count_) {
+        heap_.push_back(document);
+        std::push_heap(heap_.begin(), heap_.end(), IsBetter);
+    }
+    else if (max_count_ > 0 && IsBetter(document, heap_.front())) {
+        std::pop_heap(heap_.begin(), heap_.end(), IsBetter);
+        heap_.back() = document;
+        std::push_heap(heap_.begin(), heap_.end(), IsBetter);
+    }
+}
+
+int TopDocuments::size() const {
+    return static_cast<int>(heap_.size());
+}
+
+bool TopDocuments::IsFull() const {
+    return heap_.size() == max_count_;
+}
+
+const Document& TopDocuments::GetWorst() const {
+    return heap_.front();
+}
+
+std::vector<Document> TopDocuments::Extract() {
+    std::sort_heap(heap_.begin(), heap_.end(), IsBetter);
+    return std::move(heap_);
+}
+
+int TopDocuments::ExtractTo(Document* output) {
+    std::sort_heap(heap_.begin(), heap_.end(), IsBetter);
+    std::copy(heap_.begin(), heap_.end(), output);
+    const int count = size();
+    heap_.clear();
+    return count;
+}
+
+bool TopDocuments::IsBetter(const Document& lhs, const Document& rhs) {
+    if (std::abs(lhs.relevance - rhs.relevance) < EPSILON) {
+        if (lhs.rating != rhs.rating) {
+            return lhs.rating > rhs.rating;
+        }
+        return lhs.id < rhs.id;
+    }
+    return lhs.relevance > rhs.relevance;
+}
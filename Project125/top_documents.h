@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "document.h"
+#include "thread_local_pool.h"
+
+// Отбор лучших документов ограниченной кучей: хранится не больше max_count кандидатов,
+// в вершине кучи лежит худший из них. При равных релевантности и рейтинге лучше документ с меньшим id,
+// поэтому отобранные документы не зависят от порядка, в котором они добавлялись
+class TopDocuments {
+public:
+    // Набор из пула текущего потока: куча сохраняет выделенную память между запросами
+    using Lease = ThreadLocalPool<TopDocuments>::Lease;
+
+    TopDocuments() = default;
+    explicit TopDocuments(int max_count);
+
+    // Очищает набор и задаёт новый предел
+    void Reset(int max_count);
+
+    void Push(const Document& document);
+
+    int size() const;
+    bool IsFull() const;
+    const Document& GetWorst() const;
+
+    std::vector<Document> Extract();
+    // Записывает документы от лучшего к худшему в output и очищает набор, сохраняя память кучи.
+    // Возвращает число записанных документов
+    int ExtractTo(Document* output);
+
+    static bool IsBetter(const Document& lhs, const Document& rhs);
+
+private:
+    std::size_t max_count_ = 0;
+    std::vector<Document> heap_;
+};
@@ -0,0 +1,372 @@
+#include "write_ahead_log.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Заголовок записи: длина тела и его CRC-32
+const std::size_t RECORD_HEADER_SIZE = 2 * sizeof(uint32_t);
+
+int openForAppend(const std::string& path) {
+#ifdef _WIN32
+    return _open(path.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+#endif
+}
+
+bool writeAll(int descriptor, const char* data, std::size_t size) {
+    while (size > 0) {
+#ifdef _WIN32
+        const int written = _write(descriptor, data, static_cast<unsigned>(std::min<std::size_t>(size, 1 << 30)));
+#else
+        const ssize_t written = write(descriptor, data, size);
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        data += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+bool syncFile(int descriptor) {
+#ifdef _WIN32
+    return _commit(descriptor) == 0;
+#else
+    return fsync(descriptor) == 0;
+#endif
+}
+
+bool truncateFile(int descriptor, uint64_t size) {
+#ifdef _WIN32
+    return _chsize_s(descriptor, static_cast<__int64>(size)) == 0;
+#else
+    return ftruncate(descriptor, static_cast<off_t>(size)) == 0;
+#endif
+}
+
+void closeFile(int descriptor) {
+#ifdef _WIN32
+    _close(descriptor);
+#else
+    close(descriptor);
+#endif
+}
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, const std::string& value) {
+    appendValue(out, static_cast<uint32_t>(value.size()));
+    out.append(value);
+}
+
+void encodeRecord(const LogRecord& record, uint64_t sequence, std::string& out) {
+    const std::size_t header_position = out.size();
+    out.resize(header_position + RECORD_HEADER_SIZE);
+    appendValue(out, sequence);
+    appendValue(out, static_cast<uint8_t>(record.type));
+    switch (record.type) {
+    case LogRecordType::ADD_DOCUMENT:
+        appendValue(out, static_cast<int32_t>(record.document_id));
+        appendValue(out, static_cast<int32_t>(record.status));
+        appendValue(out, static_cast<uint32_t>(record.ratings.size()));
+        for (const int rating : record.ratings) {
+            appendValue(out, static_cast<int32_t>(rating));
+        }
+        appendString(out, record.text);
+        break;
+    case LogRecordType::REMOVE_DOCUMENT:
+        appendValue(out, static_cast<int32_t>(record.document_id));
+        break;
+    case LogRecordType::SET_STOP_WORDS:
+        appendValue(out, static_cast<uint32_t>(record.stop_words.size()));
+        for (const std::string& word : record.stop_words) {
+            appendString(out, word);
+        }
+        break;
+    case LogRecordType::SET_STOP_WORDS_TEXT:
+        appendString(out, record.text);
+        break;
+    }
+    const char* body = out.data() + header_position + RECORD_HEADER_SIZE;
+    const std::size_t body_size = out.size() - header_position - RECORD_HEADER_SIZE;
+    const uint32_t header[2] = { static_cast<uint32_t>(body_size), ComputeCrc32(body, body_size) };
+    std::memcpy(out.data() + header_position, header, sizeof(header));
+}
+
+// Тело с верной контрольной суммой, которое не разбирается, - ошибка формата, а не оборванная запись
+class RecordReader {
+public:
+    RecordReader(const char* data, std::size_t size) : data_(data), size_(size) {
+    }
+
+    template <typename T>
+    T Read() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string ReadString() {
+        const uint32_t size = Read<uint32_t>();
+        return std::string(take(size), size);
+    }
+
+    bool AtEnd() const {
+        return position_ == size_;
+    }
+
+private:
+    const char* data_;
+    std::size_t size_;
+    std::size_t position_ = 0;
+
+    const char* take(std::size_t size) {
+        if (size > size_ - position_) {
+            throw std::runtime_error("Bad write-ahead log record");
+        }
+        const char* data = data_ + position_;
+        position_ += size;
+        return data;
+    }
+};
+
+LogRecord decodeRecord(const char* data, std::size_t size) {
+    RecordReader in(data, size);
+    LogRecord record;
+    record.sequence = in.Read<uint64_t>();
+    record.type = static_cast<LogRecordType>(in.Read<uint8_t>());
+    switch (record.type) {
+    case LogRecordType::ADD_DOCUMENT: {
+        record.document_id = in.Read<int32_t>();
+        record.status = static_cast<DocumentStatus>(in.Read<int32_t>());
+        const uint32_t rating_count = in.Read<uint32_t>();
+        for (uint32_t i = 0; i < rating_count; ++i) {
+            record.ratings.push_back(in.Read<int32_t>());
+        }
+        record.text = in.ReadString();
+        break;
+    }
+    case LogRecordType::REMOVE_DOCUMENT:
+        record.document_id = in.Read<int32_t>();
+        break;
+    case LogRecordType::SET_STOP_WORDS: {
+        const uint32_t word_count = in.Read<uint32_t>();
+        for (uint32_t i = 0; i < word_count; ++i) {
+            record.stop_words.push_back(in.ReadString());
+        }
+        break;
+    }
+    case LogRecordType::SET_STOP_WORDS_TEXT:
+        record.text = in.ReadString();
+        break;
+    default:
+        throw std::runtime_error("Bad write-ahead log record");
+    }
+    if (!in.AtEnd()) {
+        throw std::runtime_error("Bad write-ahead log record");
+    }
+    return record;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+// Разбирает записи до первой неполной или повреждённой и возвращает размер целой части журнала
+template <typename Function>
+std::size_t forEachRecord(const std::string& bytes, Function function) {
+    std::size_t position = 0;
+    while (bytes.size() - position >= RECORD_HEADER_SIZE) {
+        uint32_t header[2];
+        std::memcpy(header, bytes.data() + position, sizeof(header));
+        const char* body = bytes.data() + position + RECORD_HEADER_SIZE;
+        if (header[0] > bytes.size() - position - RECORD_HEADER_SIZE || ComputeCrc32(body, header[0]) != header[1]) {
+            break;
+        }
+        function(decodeRecord(body, header[0]));
+        position += RECORD_HEADER_SIZE + header[0];
+    }
+    return position;
+}
+
+}
+
+WriteAheadLog::WriteAheadLog(const std::string& path, const WriteAheadLogOptions& options, uint64_t last_sequence)
+    : path_(path), options_(options), last_sequence_(last_sequence) {
+    const std::string bytes = readFile(path);
+    const std::size_t valid_size = forEachRecord(bytes, [this](const LogRecord& record) {
+        last_sequence_ = std::max(last_sequence_, record.sequence);
+    });
+    descriptor_ = openForAppend(path);
+    if (descriptor_ < 0) {
+        throw std::runtime_error("Cannot open write-ahead log " + path);
+    }
+    if (valid_size < bytes.size() && (!truncateFile(descriptor_, valid_size) || !syncFile(descriptor_))) {
+        closeFile(descriptor_);
+        throw std::runtime_error("Cannot truncate write-ahead log " + path);
+    }
+    durable_sequence_ = last_sequence_;
+    if (options_.sync_interval.count() > 0) {
+        sync_thread_ = std::thread([this]() {
+            runSyncThread();
+        });
+    }
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    {
+        std::lock_guard guard(mutex_);
+        stopping_ = true;
+    }
+    stop_condition_.notify_one();
+    if (sync_thread_.joinable()) {
+        sync_thread_.join();
+    }
+    try {
+        Sync();
+    }
+    catch (const std::exception&) {
+    }
+    closeFile(descriptor_);
+}
+
+uint64_t WriteAheadLog::Replay(const std::string& path, uint64_t after_sequence, const std::function<void(const LogRecord&)>& apply) {
+    uint64_t last_sequence = 0;
+    forEachRecord(readFile(path), [&](const LogRecord& record) {
+        last_sequence = std::max(last_sequence, record.sequence);
+        if (record.sequence > after_sequence) {
+            apply(record);
+        }
+    });
+    return last_sequence;
+}
+
+uint64_t WriteAheadLog::Append(const LogRecord& record) {
+    uint64_t sequence = 0;
+    bool batch_is_full = false;
+    {
+        std::lock_guard guard(mutex_);
+        throwIfFailed();
+        sequence = ++last_sequence_;
+        encodeRecord(record, sequence, buffer_);
+        ++buffered_records_;
+        batch_is_full = buffered_records_ >= options_.sync_batch_records || buffer_.size() >= options_.sync_batch_bytes;
+    }
+    if (batch_is_full) {
+        Sync();
+    }
+    return sequence;
+}
+
+void WriteAheadLog::Sync() {
+    std::lock_guard sync_guard(sync_mutex_);
+    uint64_t sequence = 0;
+    {
+        std::lock_guard guard(mutex_);
+        throwIfFailed();
+        writing_.swap(buffer_);
+        buffered_records_ = 0;
+        sequence = last_sequence_;
+    }
+    if (!writing_.empty()) {
+        if (!writeAll(descriptor_, writing_.data(), writing_.size()) || !syncFile(descriptor_)) {
+            fail("Cannot write to write-ahead log " + path_);
+        }
+        writing_.clear();
+    }
+    durable_sequence_ = sequence;
+}
+
+void WriteAheadLog::Truncate() {
+    std::lock_guard sync_guard(sync_mutex_);
+    std::lock_guard guard(mutex_);
+    throwIfFailed();
+    buffer_.clear();
+    buffered_records_ = 0;
+    if (!truncateFile(descriptor_, 0) || !syncFile(descriptor_)) {
+        error_ = std::make_exception_ptr(std::runtime_error("Cannot truncate write-ahead log " + path_));
+        std::rethrow_exception(error_);
+    }
+    durable_sequence_ = last_sequence_;
+}
+
+uint64_t WriteAheadLog::GetLastSequence() const {
+    std::lock_guard guard(mutex_);
+    return last_sequence_;
+}
+
+uint64_t WriteAheadLog::GetDurableSequence() const {
+    return durable_sequence_;
+}
+
+void WriteAheadLog::runSyncThread() {
+    std::unique_lock lock(mutex_);
+    while (!stopping_) {
+        stop_condition_.wait_for(lock, options_.sync_interval);
+        if (stopping_ || buffer_.empty() || error_) {
+            continue;
+        }
+        lock.unlock();
+        try {
+            Sync();
+        }
+        catch (const std::exception&) {
+            // Ошибка сохранена в error_ и будет брошена из следующего Append или Sync
+        }
+        lock.lock();
+    }
+}
+
+void WriteAheadLog::throwIfFailed() const {
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+// После неудачной записи неизвестно, какая часть пакета попала в файл, поэтому журнал больше не принимает записей
+void WriteAheadLog::fail(const std::string& message) {
+    std::lock_guard guard(mutex_);
+    error_ = std::make_exception_ptr(std::runtime_error(message));
+    std::rethrow_exception(error_);
+}
+
+// CRC-32 (IEEE 802.3) по таблице на 256 значений байта
+uint32_t ComputeCrc32(const char* data, std::size_t size) {
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> result{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t value = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+            result[i] = value;
+        }
+        return result;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "document.h"
+
+enum class LogRecordType : uint8_t {
+    ADD_DOCUMENT = 1,
+    REMOVE_DOCUMENT = 2,
+    SET_STOP_WORDS = 3,
+    SET_STOP_WORDS_TEXT = 4,
+};
+
+// Изменение сервера в журнале. Поля, которые не нужны типу записи, остаются пустыми
+struct LogRecord {
+    LogRecordType type = LogRecordType::ADD_DOCUMENT;
+    uint64_t sequence = 0;
+    int document_id = 0;
+    DocumentStatus status = DocumentStatus::ACTUAL;
+    std::vector<int> ratings;
+    std::string text;
+    std::vector<std::string> stop_words;
+};
+
+struct WriteAheadLogOptions {
+    // Записи копятся в памяти и уходят в файл одним write и одним fsync, когда их набирается
+    // sync_batch_records или sync_batch_bytes байт
+    int sync_batch_records = 128;
+    std::size_t sync_batch_bytes = 1 << 20;
+    // Фоновый поток сбрасывает неполный пакет не реже этого интервала и так ограничивает окно потерь при сбое.
+    // Нулевой интервал отключает поток: пакет пишется только при заполнении и в Sync
+    std::chrono::milliseconds sync_interval{ 10 };
+};
+
+// Журнал упреждающей записи: файл, в который только дописываются записи вида
+// длина, CRC-32 и тело. Сбой посреди записи оставляет неполный или повреждённый хвост,
+// он отбрасывается при чтении и обрезается при открытии журнала
+class WriteAheadLog {
+public:
+    // Открывает журнал для дописывания. Номера новых записей идут после last_sequence и после последней записи файла
+    WriteAheadLog(const std::string& path, const WriteAheadLogOptions& options, uint64_t last_sequence = 0);
+    ~WriteAheadLog();
+
+    WriteAheadLog(const WriteAheadLog&) = delete;
+    WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+
+    // Передаёт apply записи с номерами больше after_sequence по порядку и возвращает номер последней записи.
+    // Журнала может не быть, тогда записей нет
+    static uint64_t Replay(const std::string& path, uint64_t after_sequence, const std::function<void(const LogRecord&)>& apply);
+
+    // Дописывает запись в пакет и возвращает её номер. Запись на диске после Sync или после сброса пакета
+    uint64_t Append(const LogRecord& record);
+    // Пишет накопленный пакет и дожидается fsync
+    void Sync();
+    // Очищает журнал: все его записи уже сохранены в снимке
+    void Truncate();
+
+    uint64_t GetLastSequence() const;
+    uint64_t GetDurableSequence() const;
+
+private:
+    std::string path_;
+    WriteAheadLogOptions options_;
+    int descriptor_ = -1;
+
+    mutable std::mutex mutex_;
+    std::string buffer_;
+    int buffered_records_ = 0;
+    uint64_t last_sequence_ = 0;
+    std::exception_ptr error_;
+
+    // Порядок записи пакетов в файл: mutex_ берётся только на обмен буферов, запись и fsync идут без него
+    std::mutex sync_mutex_;
+    std::string writing_;
+    std::atomic<uint64_t> durable_sequence_{ 0 };
+
+    std::condition_variable stop_condition_;
+    bool stopping_ = false;
+    std::thread sync_thread_;
+
+    void runSyncThread();
+    void throwIfFailed() const;
+    void fail(const std::string& message);
+};
+
+uint32_t ComputeCrc32(const char* data, std::size_t size);